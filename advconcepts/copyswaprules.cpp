@@ -1,44 +1,209 @@
 // copy-swap idiom and the rules of five/three/zero
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <sys/mman.h>
+
+// counts every allocation of the program through the hook in instrumentation.hpp, so the assignment checks can count buffers
+#define INSTRUMENTATION_HOOK_NEW
+#include "instrumentation.hpp"
 
 // understanding the rules of five/three/zero along with the copy-swap idiom using the naive vector example
 // (i.e. creating a vector class from scratch)
 
+// growing a buffer one element at a time means that building an N-element vector copies 1 + 2 + ... + N elements, which is O(N^2)
+// instead the NaiveVector family keeps a capacity besides the size, and when it runs out of room it grows the capacity geometrically
+// (multiplies it by a factor). each element is then copied O(1) times on average, so push_back is amortised O(1)
+// 2 is what most std::vector implementations use; a factor below ~1.6 lets a later allocation reuse the blocks freed earlier
+inline double naiveGrowthFactor = 2.0;
+
+// the capacity to grow to when at least 'required' elements have to fit
+inline size_t nextCapacity(size_t capacity, size_t required) {
+    size_t grown = static_cast<size_t>(capacity * naiveGrowthFactor);
+    return std::max({grown, capacity + 1, required});
+}
+
+// relocation - moving an element to a new address and destroying the original. in general this takes a move constructor call plus a
+// destructor call per element, but for most types the combination is equivalent to copying the bytes and forgetting the original
+// (a type is NOT trivially relocatable when it points into itself, like a libstdc++ std::string pointing to its own short buffer)
+// the compiler cannot tell this apart, so the trait below is an opt-in: trivially copyable types get it for free, and other types can
+// specialise it to true_type to have the whole buffer moved with one memcpy when the vector grows
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// relocates 'size' elements from 'from' into the uninitialised storage at 'to' - afterwards 'from' holds no live objects
+template<typename T>
+void relocateElements(T* from, size_t size, T* to) {
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if(size) std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size * sizeof(T));
+    } else {
+        std::uninitialized_move(from, from + size, to);
+        std::destroy(from, from + size);
+    }
+}
+
+// moves the first 'size' elements into a new buffer of 'newCapacity' elements and frees the old one - shared by the whole family
+// int is trivially relocatable, so this ends up as a single memcpy of the whole buffer
+inline int* relocate(int* oldPtr, size_t size, size_t newCapacity) {
+    int* newPtr = newCapacity ? new int[newCapacity] : nullptr;
+    relocateElements(oldPtr, size, newPtr);
+    delete[] oldPtr;
+    return newPtr;
+}
+
+// storage policies - where the buffer of a NaiveVectorFinal comes from, and how it grows. only NaiveVectorFinal takes one: Three and
+// Five stay the plain versions of their rules, and Zero leaves its buffer to std::vector
+// heapStorage is what the rest of the family does: new[] / delete[], with growth through relocate
+struct heapStorage {
+    static int* allocate(size_t capacity) {
+        return capacity ? new int[capacity] : nullptr;
+    }
+
+    static void deallocate(int* ptr, size_t) {
+        delete[] ptr;
+    }
+
+    static int* reallocate(int* ptr, size_t size, size_t, size_t newCapacity) {
+        return relocate(ptr, size, newCapacity);
+    }
+};
+
+// mmapStorage is meant for very large buffers (GBs). with 4K pages such a buffer needs hundreds of thousands of TLB entries, so random
+// access keeps missing the TLB - big buffers are therefore mapped directly with mmap and marked with MADV_HUGEPAGE, so the kernel backs
+// them with 2MB pages. growing uses mremap, which moves the page table entries instead of the data: there is no allocate-copy-free, and
+// often the mapping can even be extended in place. (that is only valid because int is trivially relocatable)
+// small buffers are not worth a mapping of their own, so below the threshold this falls back to the heap - the capacity tells which
+// of the two a buffer came from
+// mmap only guarantees 4K alignment, and the kernel can only put a huge page on a 2MB-aligned range - so mappings are made 2MB
+// larger than needed, and the unaligned head and the tail are unmapped again
+struct mmapStorage {
+    static constexpr size_t hugePageSize = size_t(2) << 20;
+
+    static bool isMapped(size_t capacity) {
+        return capacity * sizeof(int) >= hugePageSize;
+    }
+
+    // mappings are rounded up to whole huge pages
+    static size_t mappedBytes(size_t capacity) {
+        return (capacity * sizeof(int) + hugePageSize - 1) / hugePageSize * hugePageSize;
+    }
+
+    static void adviseHugePages(void* ptr, size_t bytes) {
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+    }
+
+    // a 2MB-aligned mapping of 'bytes' (a multiple of the huge page size)
+    static void* mapAligned(size_t bytes) {
+        size_t span = bytes + hugePageSize;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(raw == MAP_FAILED) throw std::bad_alloc();
+        char* start = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + hugePageSize - 1) & ~(uintptr_t(hugePageSize) - 1));
+        size_t head = start - static_cast<char*>(raw);
+        if(head) munmap(raw, head);
+        if(hugePageSize - head) munmap(start + bytes, hugePageSize - head);
+        return start;
+    }
+
+    static int* allocate(size_t capacity) {
+        if(!isMapped(capacity)) return heapStorage::allocate(capacity);
+        size_t bytes = mappedBytes(capacity);
+        void* ptr = mapAligned(bytes);
+        adviseHugePages(ptr, bytes);
+        return static_cast<int*>(ptr);
+    }
+
+    static void deallocate(int* ptr, size_t capacity) {
+        if(!isMapped(capacity)) heapStorage::deallocate(ptr, capacity);
+        else if(ptr) munmap(ptr, mappedBytes(capacity));
+    }
+
+    static int* reallocate(int* ptr, size_t size, size_t oldCapacity, size_t newCapacity) {
+        static_assert(is_trivially_relocatable<int>::value, "mremap moves the bytes, so the elements must be trivially relocatable");
+#if defined(MREMAP_MAYMOVE) && defined(MREMAP_FIXED)
+        if(isMapped(oldCapacity) && isMapped(newCapacity)) {
+            size_t oldBytes = mappedBytes(oldCapacity), newBytes = mappedBytes(newCapacity);
+            // in place first - the start stays where it is, so it stays aligned
+            void* newPtr = mremap(ptr, oldBytes, newBytes, 0);
+            if(newPtr == MAP_FAILED) {
+                // otherwise the pages are moved into a fresh aligned range, which the move replaces (a plain MREMAP_MAYMOVE would
+                // pick any 4K-aligned address)
+                void* target = mapAligned(newBytes);
+                newPtr = mremap(ptr, oldBytes, newBytes, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                if(newPtr == MAP_FAILED) {
+                    munmap(target, newBytes);
+                    throw std::bad_alloc();
+                }
+            }
+            adviseHugePages(newPtr, newBytes);
+            return static_cast<int*>(newPtr);
+        }
+#endif
+        // crossing the threshold (or no mremap on this platform) - allocate, relocate, free
+        int* newPtr = allocate(newCapacity);
+        relocateElements(ptr, size, newPtr);
+        deallocate(ptr, oldCapacity);
+        return newPtr;
+    }
+};
+
 // rule of three - involves writing three member functions if your class involves management of a resource: destructor, copy constructor and copy assignment
 // note that copy-swap idiom is used to implement the copy assignment operator
 class NaiveVectorThree { 
     public:
     int *mPtr;
     size_t mSize;
+    size_t mCapacity;
 
     // constructor correctly initialises mPtr with a resource
-    NaiveVectorThree() : mPtr(nullptr), mSize(0) {}
+    NaiveVectorThree() : mPtr(nullptr), mSize(0), mCapacity(0) {}
 
     // a function to implement to implement insertion at the end of NaiveVectorThree
     void push_back(int newVal) {
-        // allocate new memory since size is changing
-        int *newPtr = new int[mSize + 1];
-        // copy all elements from original resource to newPtr
-        std::copy(mPtr, mPtr + mSize, newPtr);
-        // de-allocate the old resource, and make ptr point to newPtr
-        delete[] mPtr;
-        mPtr = newPtr;
+        // allocate new memory only when the buffer is full, and then grow it geometrically
+        if(mSize == mCapacity) reserve(nextCapacity(mCapacity, mSize + 1));
         // finally insert the element and increment size
         mPtr[mSize++] = newVal;
     }
 
+    // makes room for at least 'newCapacity' elements, moving the existing ones over to the new buffer
+    void reserve(size_t newCapacity) {
+        if(newCapacity <= mCapacity) return;
+        mPtr = relocate(mPtr, mSize, newCapacity);
+        mCapacity = newCapacity;
+    }
+
+    // gives the unused capacity back
+    void shrink_to_fit() {
+        if(mCapacity == mSize) return;
+        mPtr = relocate(mPtr, mSize, mSize);
+        mCapacity = mSize;
+    }
+
     // note that, without a destructor, we will face the problem of resource leak - when objects of this class go out of scope the destructor 
     // does not de-allocate this resource by itself. hence, we write a destructor manually, wherein we de-allocate all these resources
     ~NaiveVectorThree() {
         mSize = 0;
+        mCapacity = 0;
         delete[] mPtr;
     }
 
     // to avoid double-free problems, we write copy constructors - applies to memory or any resource you might be managing
+    // (only the elements are copied, so the copy has no spare capacity)
     NaiveVectorThree(const NaiveVectorThree& rhs) {
         mPtr = new int[rhs.mSize];
         mSize = rhs.mSize;
+        mCapacity = rhs.mSize;
         std::copy(rhs.mPtr, rhs.mPtr + mSize, mPtr);
     }
 
@@ -52,6 +217,7 @@ class NaiveVectorThree {
         delete mPtr;                                   // if it was a self assignment, we would have lost the data here itself
         mPtr = new int[rhs.mSize];
         mSize = rhs.mSize; 
+        mCapacity = rhs.mSize;
         std::copy(rhs.mPtr, rhs.mPtr + mSize, mPtr);  // contains garbage values
         return *this;
     }
@@ -82,53 +248,89 @@ class NaiveVectorFive {
     public: 
         int* mPtr;
         size_t mSize;
+        size_t mCapacity;
 
         // swap member function to perform the copy-swap in assignment operators
         void swap(NaiveVectorFive& rhs) noexcept {
             using std::swap;
             swap(mPtr, rhs.mPtr);
             swap(mSize, rhs.mSize);
+            swap(mCapacity, rhs.mCapacity);
         }
 
         // constructor to initialise the vector
-        NaiveVectorFive() : mPtr(nullptr), mSize(0) {}
+        NaiveVectorFive() : mPtr(nullptr), mSize(0), mCapacity(0) {}
+
+        // insertion at the end - the buffer only grows (geometrically) when it is full
+        void push_back(int newVal) {
+            if(mSize == mCapacity) reserve(nextCapacity(mCapacity, mSize + 1));
+            mPtr[mSize++] = newVal;
+        }
+
+        // makes room for at least 'newCapacity' elements, moving the existing ones over to the new buffer
+        void reserve(size_t newCapacity) {
+            if(newCapacity <= mCapacity) return;
+            mPtr = relocate(mPtr, mSize, newCapacity);
+            mCapacity = newCapacity;
+        }
+
+        // gives the unused capacity back
+        void shrink_to_fit() {
+            if(mCapacity == mSize) return;
+            mPtr = relocate(mPtr, mSize, mSize);
+            mCapacity = mSize;
+        }
 
         // copy constructor to copy from one vector to another - helps avoid double-free problem
         NaiveVectorFive(const NaiveVectorFive& rhs) {
             mPtr = new int[rhs.mSize];
             mSize = rhs.mSize;
+            mCapacity = rhs.mSize;
             std::copy(rhs.mPtr, rhs.mPtr + mSize, mPtr);
         }
 
         // move constructor to transfer the ownership of a vector from one instance to another - helps avoid unnecessary copying
-        NaiveVectorFive(NaiveVectorFive&& rhs) {
+        NaiveVectorFive(NaiveVectorFive&& rhs) noexcept {
             // std::exchange function - replaces the old value of object with the new value, and returns the old value
             // which is being assigned to the current instance here
             mPtr = std::exchange(rhs.mPtr, nullptr);
             mSize = std::exchange(rhs.mSize, 0);
+            mCapacity = std::exchange(rhs.mCapacity, 0);
         }
 
-        // copy assignment operator to free the left-hand resource and copy the right-hand resource to it (copy-swap idiom used)
+        // copy assignment operator to free the left-hand resource and copy the right-hand resource to it
+        // plain copy-swap (NaiveVectorFive copy(rhs); copy.swap(*this);) always allocates, even when our buffer is already big enough
+        // so the existing buffer is reused whenever it has room, and only otherwise a new one is allocated (once), filled, and swapped in
+        // self-assignment returns early - std::copy onto its own range is undefined (the output may not start inside the input)
         NaiveVectorFive& operator=(const NaiveVectorFive& rhs) {
-            NaiveVectorFive copy(rhs);
-            copy.swap(*this);
+            if(this == &rhs) return *this;
+            if(rhs.mSize <= mCapacity) {
+                std::copy(rhs.mPtr, rhs.mPtr + rhs.mSize, mPtr);
+                mSize = rhs.mSize;
+            } else {
+                NaiveVectorFive copy(rhs);
+                copy.swap(*this);
+            }
             return *this;
         }   
 
-        // move assignment operator to free the left-hand resource and transfer ownership of the right-hand resource to it (copy-swap idiom used)
-        NaiveVectorFive& operator=(NaiveVectorFive&& rhs) {
-            NaiveVectorFive copy(rhs);
-            copy.swap(*this);
+        // move assignment operator to free the left-hand resource and transfer ownership of the right-hand resource to it
+        // 'rhs' is an rvalue, so there is nothing to copy - the move constructor steals its buffer into a temporary, which is then swapped
+        // with *this. the temporary takes our old buffer with it when it is destroyed, and nothing is allocated
+        NaiveVectorFive& operator=(NaiveVectorFive&& rhs) noexcept {
+            NaiveVectorFive stolen(std::move(rhs));
+            stolen.swap(*this);
             return *this;
         }
         
-        // we can clearly notice that usage of copy-swap makes the code almost identical for the copy and move assignment member functions
+        // we can clearly notice that usage of copy-swap makes the code for the copy and move assignment member functions very similar
         // one possible solution to this is - writing one assignment operator function, but the parameter is passed by value - copy left upto the caller
         // this introduces a new rule - rule of four (and a half which is the swap function to implement copy-swap)
 
         // destructor to de-allocate the resource and reset the size - helps avoid resource leaks
         ~NaiveVectorFive() {
             mSize = 0;
+            mCapacity = 0;
             delete[] mPtr;
         }
 };
@@ -136,25 +338,50 @@ class NaiveVectorFive {
 // this redundant assignment operator code leads to a new rule - the rule of four - where every class that manages some kind of resource directly should
 // have four (and a half) special hand-written member functions: destructor, copy constructor, move constructor, by-value assignment operator (and the half
 // stands for the custom swap function which can have both a non-member and member version)
+// the buffer is managed through a storage policy (heapStorage by default, mmapStorage for huge buffers) - see above
+template<typename Storage = heapStorage>
 class NaiveVectorFinal {
     public: 
         int* mPtr;
         size_t mSize;
+        size_t mCapacity;
 
         // swap member function to perform the copy-swap in assignment operators
         void swap(NaiveVectorFinal& rhs) noexcept {
             using std::swap;
             swap(mPtr, rhs.mPtr);
             swap(mSize, rhs.mSize);
+            swap(mCapacity, rhs.mCapacity);
         }
 
         // constructor to initialise the vector
-        NaiveVectorFinal() : mPtr(nullptr), mSize(0) {}
+        NaiveVectorFinal() : mPtr(nullptr), mSize(0), mCapacity(0) {}
+
+        // insertion at the end - the buffer only grows (geometrically) when it is full
+        void push_back(int newVal) {
+            if(mSize == mCapacity) reserve(nextCapacity(mCapacity, mSize + 1));
+            mPtr[mSize++] = newVal;
+        }
+
+        // makes room for at least 'newCapacity' elements, moving the existing ones over to the new buffer
+        void reserve(size_t newCapacity) {
+            if(newCapacity <= mCapacity) return;
+            mPtr = Storage::reallocate(mPtr, mSize, mCapacity, newCapacity);
+            mCapacity = newCapacity;
+        }
+
+        // gives the unused capacity back
+        void shrink_to_fit() {
+            if(mCapacity == mSize) return;
+            mPtr = Storage::reallocate(mPtr, mSize, mCapacity, mSize);
+            mCapacity = mSize;
+        }
 
         // copy constructor to copy from one vector to another - helps avoid double-free problem
         NaiveVectorFinal(const NaiveVectorFinal& rhs) {
-            mPtr = new int[rhs.mSize];
+            mPtr = Storage::allocate(rhs.mSize);
             mSize = rhs.mSize;
+            mCapacity = rhs.mSize;
             std::copy(rhs.mPtr, rhs.mPtr + mSize, mPtr);
         }
 
@@ -164,24 +391,245 @@ class NaiveVectorFinal {
             // which is being assigned to the current instance here
             mPtr = std::exchange(rhs.mPtr, nullptr);
             mSize = std::exchange(rhs.mSize, 0);
+            mCapacity = std::exchange(rhs.mCapacity, 0);
         }
 
         // a common assignment operator to free the left-hand resource and transfer the right-hand resource to it (copy-swap idiom used)
         // both copy and move assignment will work here - upto the compiler to do the copying job in the argument of the function
-        NaiveVectorFinal& operator=(NaiveVectorFinal rhs) {
-            NaiveVectorFinal copy(rhs);
-            copy.swap(*this);
+        // 'rhs' already is the copy (or the moved-from value), so it only has to be swapped in - copying it once more would allocate again
+        // the price of the single by-value operator is that a copy always allocates, even if our buffer was big enough; when that matters,
+        // write the two operators separately as in NaiveVectorFive
+        NaiveVectorFinal& operator=(NaiveVectorFinal rhs) noexcept {
+            rhs.swap(*this);
             return *this;
         }   
 
         // destructor to de-allocate the resource and reset the size - helps avoid resource leaks
         ~NaiveVectorFinal() {
+            Storage::deallocate(mPtr, mCapacity);
             mSize = 0;
-            delete[] mPtr;
+            mCapacity = 0;
         }
 };
 
-int main() {
+// runs 'assign' and returns how many buffers it allocated
+template<typename Assign>
+long allocationsOf(Assign assign) {
+    allocationCounts before = allocationSnapshot();
+    assign();
+    return (allocationSnapshot() - before).allocations;
+}
+
+template<typename Vector>
+Vector filledWith(size_t n) {
+    Vector v;
+    v.reserve(n);
+    for(size_t i=0; i<n; i++) v.push_back(int(i));
+    return v;
+}
+
+// prints a failed check - the checks below run with or without NDEBUG, so they are not written with assert
+bool expect(bool condition, const char* what) {
+    if(!condition) std::cerr << "assignment check failed: " << what << std::endl;
+    return condition;
+}
+
+// checks that move assignment never allocates, and that copy assignment allocates at most once (never, for NaiveVectorFive, when the
+// destination already has enough capacity)
+bool checkAssignmentAllocations() {
+    bool ok = true;
+    NaiveVectorFive big = filledWith<NaiveVectorFive>(100), small = filledWith<NaiveVectorFive>(10);
+    long allocations = allocationsOf([&] { big = small; });                                             // reuses the capacity
+    ok &= expect(allocations == 0 && big.mSize == 10 && big.mPtr[9] == 9, "NaiveVectorFive big = small");
+    allocations = allocationsOf([&] { small = filledWith<NaiveVectorFive>(50); });                     // only the temporary's buffer
+    ok &= expect(allocations == 1, "NaiveVectorFive small = temporary");
+    allocations = allocationsOf([&] { small = big; });
+    ok &= expect(allocations == 0 && small.mSize == 10, "NaiveVectorFive small = big");
+    NaiveVectorFive tiny;
+    allocations = allocationsOf([&] { tiny = big; });
+    ok &= expect(allocations == 1 && tiny.mSize == 10, "NaiveVectorFive tiny = big");
+    allocations = allocationsOf([&] { tiny = tiny; });
+    ok &= expect(allocations == 0 && tiny.mSize == 10 && tiny.mPtr[5] == 5, "NaiveVectorFive tiny = tiny");
+    allocations = allocationsOf([&] { tiny = std::move(big); });
+    ok &= expect(allocations == 0 && tiny.mSize == 10, "NaiveVectorFive tiny = std::move(big)");
+
+    NaiveVectorFinal<> a = filledWith<NaiveVectorFinal<>>(100), b = filledWith<NaiveVectorFinal<>>(10);
+    allocations = allocationsOf([&] { a = b; });
+    ok &= expect(allocations == 1 && a.mSize == 10 && a.mPtr[9] == 9, "NaiveVectorFinal a = b");
+    allocations = allocationsOf([&] { a = std::move(b); });
+    ok &= expect(allocations == 0 && a.mSize == 10, "NaiveVectorFinal a = std::move(b)");
+    allocations = allocationsOf([&] { a = a; });
+    ok &= expect(allocations == 1 && a.mSize == 10, "NaiveVectorFinal a = a");
+
+    if(ok) std::cout << "assignment allocation checks passed" << std::endl;
+    return ok;
+}
+
+// assignment microbenchmark - nanoseconds per assignment of a 1000-element vector
+template<typename Vector>
+void benchmarkAssignment(const char* name) {
+    constexpr long repeats = 1000000;
+    Vector source = filledWith<Vector>(1000), target = filledWith<Vector>(1000);
+
+    auto start = std::chrono::steady_clock::now();
+    for(long i=0; i<repeats; i++) {
+        target = source;
+        asm volatile("" : : "r"(&target) : "memory");
+    }
+    std::chrono::duration<double, std::nano> copyTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(long i=0; i<repeats; i++) {
+        target = std::move(source);
+        source = std::move(target);
+        asm volatile("" : : "r"(&target), "r"(&source) : "memory");
+    }
+    std::chrono::duration<double, std::nano> moveTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << copyTime.count() / repeats << " ns/copy assignment, " << moveTime.count() / (2 * repeats)
+              << " ns/move assignment" << std::endl;
+}
+
+// payloads for the relocation benchmark
+// a plain 32-byte struct - trivially copyable, so trivially relocatable without any opt-in
+struct PodPayload {
+    long values[4];
+};
+
+// a string with a short buffer, laid out like libc++'s std::string rather than libstdc++'s - short strings are stored inline and long
+// ones on the heap, but it never points into itself, so copying its bytes to a new address is a valid move
+class StringLike {
+    private:
+        static constexpr size_t shortCapacity = 23;
+        size_t mSize;
+        union {
+            char* mHeap;
+            char mLocal[shortCapacity + 1];
+        };
+
+        bool isShort() const { return mSize <= shortCapacity; }
+
+    public:
+        explicit StringLike(const char* str) : mSize(std::strlen(str)) {
+            char* dest = isShort() ? mLocal : (mHeap = new char[mSize + 1]);
+            std::memcpy(dest, str, mSize + 1);
+        }
+
+        StringLike(const StringLike& rhs) : StringLike(rhs.c_str()) {}
+
+        StringLike(StringLike&& rhs) noexcept : mSize(rhs.mSize) {
+            if(isShort()) std::memcpy(mLocal, rhs.mLocal, mSize + 1);
+            else mHeap = std::exchange(rhs.mHeap, nullptr);
+            rhs.mSize = 0;
+            rhs.mLocal[0] = '\0';
+        }
+
+        StringLike& operator=(const StringLike&) = delete;
+
+        ~StringLike() {
+            if(!isShort()) delete[] mHeap;
+        }
+
+        const char* c_str() const { return isShort() ? mLocal : mHeap; }
+};
+
+// opting StringLike in - it has user-written special members, so the compiler would never treat it as trivially relocatable by itself
+template<>
+struct is_trivially_relocatable<StringLike> : std::true_type {};
+
+// wraps a type and hides its relocatability, so the benchmark can run the element-wise path on exactly the same data
+template<typename T>
+struct ElementWise {
+    T value;
+    template<typename... Args>
+    explicit ElementWise(Args&&... args) : value(std::forward<Args>(args)...) {}
+    ElementWise(ElementWise&& rhs) noexcept : value(std::move(rhs.value)) {}
+    ~ElementWise() {}
+};
+
+// grows a raw buffer the same way the NaiveVector family does (geometric growth + relocateElements) until it holds 'targetBytes' of
+// elements, and reports the time spent and the bytes relocated per second
+template<typename T, typename Make>
+void benchmarkRelocation(const char* name, size_t targetBytes, Make make) {
+    size_t size = 0, capacity = 0, relocatedBytes = 0;
+    T* buffer = nullptr;
+    double relocationSeconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    while(size * sizeof(T) < targetBytes) {
+        if(size == capacity) {
+            size_t newCapacity = nextCapacity(capacity, size + 1);
+            T* newBuffer = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+            auto relocationStart = std::chrono::steady_clock::now();
+            relocateElements(buffer, size, newBuffer);
+            relocationSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - relocationStart).count();
+            relocatedBytes += size * sizeof(T);
+            ::operator delete(buffer);
+            buffer = newBuffer;
+            capacity = newCapacity;
+        }
+        ::new (static_cast<void*>(buffer + size)) T(make(size));
+        size++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::destroy(buffer, buffer + size);
+    ::operator delete(buffer);
+    std::cout << name << elapsed.count() << " s total, " << relocationSeconds << " s relocating ("
+              << relocatedBytes / relocationSeconds / 1e9 << " GB/s)" << std::endl;
+}
+
+// storage policy benchmark - grows an n-element NaiveVectorFinal with the given storage, then measures a sequential scan (GB/s) and
+// random reads spread over the whole buffer (M reads/s, this is where the TLB misses show)
+template<typename Storage>
+void benchmarkStorage(const char* name, size_t n) {
+    auto start = std::chrono::steady_clock::now();
+    NaiveVectorFinal<Storage> v;
+    for(size_t i=0; i<n; i++) v.push_back(int(i));
+    std::chrono::duration<double> growTime = std::chrono::steady_clock::now() - start;
+
+    long sum = 0;
+    start = std::chrono::steady_clock::now();
+    for(size_t i=0; i<n; i++) sum += v.mPtr[i];
+    std::chrono::duration<double> scanTime = std::chrono::steady_clock::now() - start;
+
+    // a linear congruential generator picks the indices, so that the reads do not depend on each other's results
+    constexpr size_t reads = 20000000;
+    unsigned long long state = 12345;
+    start = std::chrono::steady_clock::now();
+    for(size_t i=0; i<reads; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        sum += v.mPtr[(state >> 20) % n];
+    }
+    std::chrono::duration<double> randomTime = std::chrono::steady_clock::now() - start;
+    asm volatile("" : : "r"(sum));
+
+    std::cout << name << "grow " << growTime.count() << " s, scan " << n * sizeof(int) / scanTime.count() / 1e9 << " GB/s, random "
+              << reads / randomTime.count() / 1e6 << " M reads/s" << std::endl;
+}
+
+// push_back throughput benchmark - builds an n-element vector from empty (repeating small sizes so that each measurement covers about
+// 10M insertions) and reports millions of push_backs per second
+template<typename Vector>
+double pushBacksPerSecond(size_t n) {
+    size_t repeats = std::max<size_t>(1, 10000000 / n);
+    auto start = std::chrono::steady_clock::now();
+    for(size_t r=0; r<repeats; r++) {
+        Vector v;
+        for(size_t i=0; i<n; i++) v.push_back(int(i));
+        asm volatile("" : : "r"(&v) : "memory");
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return n * repeats / elapsed.count() / 1e6;
+}
+
+void benchmarkPushBack(size_t maxElements) {
+    std::cout << "elements\tNaiveVectorThree\tNaiveVectorFinal\tstd::vector<int>   (M push_back/s)" << std::endl;
+    for(size_t n = 1000; n <= maxElements; n *= 10) {
+        std::cout << n << "\t\t" << pushBacksPerSecond<NaiveVectorThree>(n) << "\t\t\t" << pushBacksPerSecond<NaiveVectorFinal<>>(n)
+                  << "\t\t\t" << pushBacksPerSecond<std::vector<int>>(n) << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     // NaiveVector v;
     // v.push_back(1);
 
@@ -198,6 +646,34 @@ int main() {
     // since the memory being pointed by 'v' has already been freed in the previous line, this leads to undefined behaviour
     // std::cout << v[0] << std::endl;
 
+    if(!checkAssignmentAllocations()) return 1;
+    benchmarkAssignment<NaiveVectorFive>("NaiveVectorFive  : ");
+    benchmarkAssignment<NaiveVectorFinal<>>("NaiveVectorFinal : ");
+    benchmarkAssignment<std::vector<int>>("std::vector<int> : ");
+
+    // growth benchmark, from 1K up to 100M elements by default
+    benchmarkPushBack(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000);
+
+    // relocation benchmark - memcpy against element-wise relocation, growing to 1GB by default
+    size_t targetBytes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (size_t(1) << 30);
+    auto makePod = [](size_t i) { return PodPayload{{long(i), long(i), long(i), long(i)}}; };
+    auto makeString = [](size_t) { return "short string payload"; };
+    benchmarkRelocation<PodPayload>("POD, memcpy               : ", targetBytes, makePod);
+    benchmarkRelocation<ElementWise<PodPayload>>("POD, element-wise         : ", targetBytes, makePod);
+    benchmarkRelocation<StringLike>("StringLike, memcpy        : ", targetBytes, makeString);
+    benchmarkRelocation<ElementWise<StringLike>>("StringLike, element-wise  : ", targetBytes, makeString);
+
+    // storage policies - 256M ints (1GB) by default
+    size_t storageElements = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : (size_t(1) << 28);
+    benchmarkStorage<heapStorage>("heapStorage : ", storageElements);
+    benchmarkStorage<mmapStorage>("mmapStorage : ", storageElements);
+
+    // a mapped buffer starts on a huge page boundary, both when it is first mapped (at 2MB) and after mremap has grown it (to 4MB)
+    NaiveVectorFinal<mmapStorage> mapped;
+    for(int i=0; i<(1 << 20); i++) mapped.push_back(i);
+    bool aligned = reinterpret_cast<uintptr_t>(mapped.mPtr) % mmapStorage::hugePageSize == 0;
+    if(!expect(aligned && mapped.mPtr[(1 << 20) - 1] == (1 << 20) - 1, "mmapStorage buffers are 2MB aligned")) return 1;
+
     return 0;
 
     // now when finally 'v' goes out of scope, its destructor is called, which leads to the double-free problem (freeing memory which is already freed previously)
@@ -0,0 +1,298 @@
+// epoch based reclamation - cheap safe memory reclamation for read-mostly structures
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include "smartpointersimpl.hpp"
+
+// compile with: g++ -std=c++17 -O2 -pthread epochreclamation.cpp -o epochreclamation
+// run with:     ./epochreclamation [max threads] [reads per thread]
+
+// hazard pointers (hazardpointers.cpp) make a reader publish every single pointer it is about to use. for read-dominated structures like
+// lookup tables even that is more than needed - epoch based reclamation only asks a reader to announce *when* it is reading:
+// 1. there is a global epoch counter. a reader 'pins' itself by copying the global epoch into its own slot before touching the
+//    structure, and unpins when done - no matter how many nodes it reads in between
+// 2. a writer which unlinks a node retires it, tagged with the global epoch at that moment
+// 3. the global epoch can only move from e to e+1 once every pinned reader has observed e. so once the global epoch is two steps past
+//    a node's tag, every reader which could have seen the node has unpinned, and the node can be freed
+// a background thread keeps trying to advance the epoch, so neither readers nor writers have to scan anything on their fast path
+
+// one slot per thread - the low bit says whether the thread is pinned, the rest is the epoch it pinned at. packing both into one word
+// lets a pin be a single store
+struct epochRecord {
+    std::atomic<std::uint64_t> state{0};
+    std::atomic<bool> inUse{false};
+    epochRecord* next = nullptr;
+};
+
+class epochManager {
+    private:
+        struct retiredNode {
+            void* ptr;
+            void (*reclaim)(void*);
+            std::uint64_t epoch;
+        };
+
+        // starts at 2 so that 'epoch - 2' never wraps around
+        std::atomic<std::uint64_t> globalEpoch{2};
+        std::atomic<epochRecord*> records{nullptr};
+
+        // deferred free lists left behind by exited threads - freed by the advancer thread
+        std::mutex orphanLock;
+        std::vector<retiredNode> orphans;
+
+        std::atomic<bool> running{true};
+        std::thread advancer;
+
+        struct threadState {
+            epochManager* manager;
+            epochRecord* rec;
+            int depth = 0;
+            std::vector<retiredNode> retired;
+
+            explicit threadState(epochManager* m) : manager(m), rec(m->acquireRecord()) {}
+
+            ~threadState() {
+                rec->state.store(0, std::memory_order_release);
+                rec->inUse.store(false, std::memory_order_release);
+                std::lock_guard<std::mutex> guard(manager->orphanLock);
+                manager->orphans.insert(manager->orphans.end(), retired.begin(), retired.end());
+            }
+        };
+
+        threadState& local() {
+            thread_local threadState state(this);
+            return state;
+        }
+
+        epochRecord* acquireRecord() {
+            for(epochRecord* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                bool expected = false;
+                if(!rec->inUse.load(std::memory_order_relaxed) &&
+                   rec->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) return rec;
+            }
+            epochRecord* rec = new epochRecord;
+            rec->inUse.store(true, std::memory_order_relaxed);
+            epochRecord* head = records.load(std::memory_order_relaxed);
+            do {
+                rec->next = head;
+            } while(!records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+            return rec;
+        }
+
+        // frees every node of 'list' whose epoch is at least two behind the global one
+        void collect(std::vector<retiredNode>& list) {
+            std::uint64_t safe = globalEpoch.load(std::memory_order_acquire) - 2;
+            auto pending = std::partition(list.begin(), list.end(), [safe](const retiredNode& node) { return node.epoch > safe; });
+            for(auto it = pending; it != list.end(); it++) it->reclaim(it->ptr);
+            list.erase(pending, list.end());
+        }
+
+        void advanceLoop() {
+            using namespace std::literals::chrono_literals;
+            while(running.load(std::memory_order_acquire)) {
+                tryAdvance();
+                {
+                    std::lock_guard<std::mutex> guard(orphanLock);
+                    collect(orphans);
+                }
+                std::this_thread::sleep_for(1ms);
+            }
+        }
+
+        epochManager() : advancer(&epochManager::advanceLoop, this) {}
+
+        friend class epochGuard;
+
+    public:
+        static epochManager& global() {
+            static epochManager manager;
+            return manager;
+        }
+
+        // pinning publishes the current epoch with one store; the fence makes sure the advancer sees the pin before this thread reads
+        // anything from the structure. if the global epoch moved on in between, the thread is pinned at an older epoch, which only
+        // holds the advancer back for a moment - it is never unsafe
+        void pin() {
+            threadState& state = local();
+            if(state.depth++ > 0) return;
+            std::uint64_t epoch = globalEpoch.load(std::memory_order_relaxed);
+            state.rec->state.store((epoch << 1) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void unpin() {
+            threadState& state = local();
+            if(--state.depth > 0) return;
+            state.rec->state.store(0, std::memory_order_release);
+        }
+
+        // moves the global epoch forward by one if every pinned thread has observed the current epoch
+        bool tryAdvance() {
+            std::uint64_t epoch = globalEpoch.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for(epochRecord* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                std::uint64_t state = rec->state.load(std::memory_order_acquire);
+                if((state & 1) && (state >> 1) != epoch) return false;
+            }
+            return globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+        }
+
+        // defers the deletion of an unlinked node - the thread's own list is collected every 64 retirements
+        // the retiring thread need not be pinned, so the fence pairs with the one in pin(), as in tryAdvance: either a reader's pin is
+        // visible to the tag load below (and the tag is no older than the reader's epoch), or that reader's loads come after the unlink
+        // and cannot reach the node
+        void retire(void* ptr, void (*reclaim)(void*)) {
+            threadState& state = local();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            state.retired.push_back(retiredNode{ptr, reclaim, globalEpoch.load(std::memory_order_acquire)});
+            if(state.retired.size() % 64 == 0) collect(state.retired);
+        }
+
+        template<typename T>
+        void retire(T* ptr) {
+            retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+        }
+
+        std::uint64_t currentEpoch() const { return globalEpoch.load(std::memory_order_relaxed); }
+
+        // at exit there are no readers left, so everything can go
+        ~epochManager() {
+            running.store(false, std::memory_order_release);
+            advancer.join();
+            for(retiredNode& node : orphans) node.reclaim(node.ptr);
+            epochRecord* rec = records.load();
+            while(rec) delete std::exchange(rec, rec->next);
+        }
+};
+
+// RAII pin - everything read from the structure inside the guard's scope stays alive until the guard is destroyed
+class epochGuard {
+    public:
+        epochGuard() { epochManager::global().pin(); }
+        ~epochGuard() { epochManager::global().unpin(); }
+
+        epochGuard(const epochGuard&) = delete;
+        epochGuard& operator=(const epochGuard&) = delete;
+};
+
+// deleter policy for uniquePtr, the same hook as hazardRetire - the resource is retired to the epoch manager instead of being deleted
+template<typename T, typename Deleter = defaultDelete<T>>
+struct epochRetire {
+    void operator()(T* ptr) const {
+        epochManager::global().retire(ptr, [](void* p) { Deleter()(static_cast<T*>(p)); });
+    }
+};
+
+template<typename T>
+using epochOwned = uniquePtr<T, epochRetire<T>>;
+
+static_assert(sizeof(epochOwned<int>) == sizeof(int*), "epochRetire is stateless and must take no space");
+
+// a read-mostly lookup table - readers look values up, and a writer occasionally publishes a whole new version
+struct Table {
+    static constexpr int size = 1024;
+    long values[size];
+    explicit Table(long version) { for(int i=0; i<size; i++) values[i] = version + i; }
+};
+
+// epoch version - the reader pins once per lookup and reads the current table through a plain atomic pointer
+class epochTable {
+    private:
+        std::atomic<Table*> current;
+
+    public:
+        epochTable() : current(new Table(0)) {}
+
+        long lookup(int key) {
+            epochGuard guard;
+            return current.load(std::memory_order_acquire)->values[key % Table::size];
+        }
+
+        // the old table is handed to an epochOwned pointer, which retires it instead of deleting it
+        void publish(long version) {
+            epochOwned<Table> old(current.exchange(new Table(version), std::memory_order_acq_rel));
+        }
+
+        ~epochTable() { delete current.load(); }
+};
+
+// refcount version - the reader takes a sharedPtr copy of the current table, so every lookup increments and decrements the same
+// shared count. sharedPtr itself cannot be read and replaced concurrently, so the copy is made under a tiny spinlock (the same thing
+// std::atomic<std::shared_ptr> does)
+class refcountTable {
+    private:
+        sharedPtr<Table> current;
+        std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+        sharedPtr<Table> snapshot() {
+            while(busy.test_and_set(std::memory_order_acquire)) {}
+            sharedPtr<Table> copy(current);
+            busy.clear(std::memory_order_release);
+            return copy;
+        }
+
+    public:
+        refcountTable() : current(makeShared<Table>(0)) {}
+
+        long lookup(int key) {
+            sharedPtr<Table> table = snapshot();
+            return table->values[key % Table::size];
+        }
+
+        void publish(long version) {
+            sharedPtr<Table> next = makeShared<Table>(version);
+            while(busy.test_and_set(std::memory_order_acquire)) {}
+            std::swap(current, next);
+            busy.clear(std::memory_order_release);
+        }
+};
+
+// reader throughput benchmark - 'numThreads' readers look values up while one writer publishes a new table version every 100us
+template<typename TableType>
+double lookupsPerSecond(int numThreads, long readsPerThread) {
+    TableType table;
+    std::atomic<bool> done(false);
+    std::thread writer([&table, &done] {
+        using namespace std::literals::chrono_literals;
+        for(long version = 1; !done.load(std::memory_order_relaxed); version++) {
+            table.publish(version);
+            std::this_thread::sleep_for(100us);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    auto start = std::chrono::steady_clock::now();
+    for(int t=0; t<numThreads; t++) {
+        readers.emplace_back([&table, readsPerThread, t] {
+            long sum = 0;
+            for(long i=0; i<readsPerThread; i++) sum += table.lookup(int(i + t));
+            asm volatile("" : : "r"(sum));
+        });
+    }
+    for(auto& th : readers) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    done.store(true);
+    writer.join();
+    return numThreads * readsPerThread / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+    long readsPerThread = argc > 2 ? std::atol(argv[2]) : 1000000;
+
+    std::cout << "threads   epoch lookups/sec   refcount lookups/sec" << std::endl;
+    for(int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        double epochRate = lookupsPerSecond<epochTable>(numThreads, readsPerThread);
+        double refcountRate = lookupsPerSecond<refcountTable>(numThreads, readsPerThread);
+        std::cout << numThreads << "\t  " << epochRate << "\t\t" << refcountRate << std::endl;
+    }
+    std::cout << "global epoch reached: " << epochManager::global().currentEpoch() << std::endl;
+
+    return 0;
+}
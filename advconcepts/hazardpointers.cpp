@@ -0,0 +1,295 @@
+// hazard pointers - safe memory reclamation for lock-free data structures
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "smartpointersimpl.hpp"
+
+// compile with: g++ -std=c++17 -O2 -pthread hazardpointers.cpp -o hazardpointers
+//               (add -fsanitize=address to check for leaks and use-after-free)
+// run with:     ./hazardpointers [threads] [total nodes]
+
+// in a lock-free structure, a thread which removes a node cannot simply delete it - another thread may have read the pointer just before
+// the removal and still be about to dereference it. reference counting every access (sharedPtr) solves this, but every reader then
+// writes to a shared counter, which is exactly the contention lock-free code tries to avoid
+
+// hazard pointers solve it differently:
+// 1. a reader publishes the pointer it is about to use in a 'hazard slot' which every thread can see
+// 2. a thread which removes a node does not delete it, it 'retires' it into its own private list
+// 3. once the retire list grows past a threshold, the thread scans all the hazard slots, and deletes every retired node which no slot
+//    points to. the rest stay in the list until a later scan
+// readers only write to their own slot, and the cost of scanning is amortised over many retirements
+
+// one published pointer - records are linked into a global list, and are never freed while the program runs, so scanning threads can
+// walk the list without any synchronisation besides the atomic loads
+struct hazardRecord {
+    std::atomic<const void*> ptr{nullptr};
+    std::atomic<bool> active{false};
+    hazardRecord* next = nullptr;
+};
+
+// a retired node, along with the function which knows how to delete it (the node's type is erased)
+struct retiredNode {
+    void* ptr;
+    void (*reclaim)(void*);
+};
+
+class hazardDomain {
+    private:
+        std::atomic<hazardRecord*> records{nullptr};
+        std::atomic<long> numRecords{0};
+
+        // nodes left behind by threads which exited while someone still protected them - rare, so a mutex is fine here
+        std::mutex orphanLock;
+        std::vector<retiredNode> orphans;
+
+        // per-thread state - the hazard slots which the thread owns, and its private retire list
+        struct threadState {
+            static constexpr int maxSlots = 4;
+            hazardDomain* domain;
+            hazardRecord* slots[maxSlots] = {};
+            int slotsInUse = 0;
+            std::vector<retiredNode> retired;
+
+            explicit threadState(hazardDomain* d) : domain(d) {}
+
+            // on thread exit the slots go back to the domain, and whatever cannot be reclaimed yet is handed over as orphans
+            ~threadState() {
+                for(hazardRecord* rec : slots) {
+                    if(rec) {
+                        rec->ptr.store(nullptr, std::memory_order_release);
+                        rec->active.store(false, std::memory_order_release);
+                    }
+                }
+                domain->scan(retired);
+                std::lock_guard<std::mutex> guard(domain->orphanLock);
+                domain->orphans.insert(domain->orphans.end(), retired.begin(), retired.end());
+                retired.clear();
+            }
+        };
+
+        // a function-local thread_local is one state per thread, not one per domain - which is why global() is the only domain there
+        // is (the constructor is private)
+        threadState& local() {
+            thread_local threadState state(this);
+            return state;
+        }
+
+        hazardDomain() = default;
+
+        // reuses an inactive record if there is one, otherwise pushes a new one on the lock-free list
+        hazardRecord* acquireRecord() {
+            for(hazardRecord* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                bool expected = false;
+                if(!rec->active.load(std::memory_order_relaxed) &&
+                   rec->active.compare_exchange_strong(expected, true, std::memory_order_acquire)) return rec;
+            }
+            hazardRecord* rec = new hazardRecord;
+            rec->active.store(true, std::memory_order_relaxed);
+            hazardRecord* head = records.load(std::memory_order_relaxed);
+            do {
+                rec->next = head;
+            } while(!records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+            numRecords.fetch_add(1, std::memory_order_relaxed);
+            return rec;
+        }
+
+        // deletes every node of 'list' which is not published in any hazard slot, and keeps the rest in 'list'
+        void scan(std::vector<retiredNode>& list) {
+            // pairs with the seq_cst store in hazardPointer::protect - either the reader sees the node already unlinked and retries,
+            // or this scan sees the reader's hazard
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::vector<const void*> hazards;
+            for(hazardRecord* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                if(const void* p = rec->ptr.load(std::memory_order_acquire)) hazards.push_back(p);
+            }
+            std::sort(hazards.begin(), hazards.end());
+
+            auto stillHazardous = std::partition(list.begin(), list.end(), [&hazards](const retiredNode& node) {
+                return std::binary_search(hazards.begin(), hazards.end(), node.ptr);
+            });
+            for(auto it = stillHazardous; it != list.end(); it++) it->reclaim(it->ptr);
+            list.erase(stillHazardous, list.end());
+        }
+
+        friend class hazardPointer;
+
+    public:
+        static hazardDomain& global() {
+            static hazardDomain domain;
+            return domain;
+        }
+
+        // retires a node which has already been unlinked from the structure - it is deleted once no hazard slot points to it
+        // the threshold grows with the number of slots, so each scan frees at least half of the list and the cost stays amortised O(1)
+        void retire(void* ptr, void (*reclaim)(void*)) {
+            threadState& state = local();
+            state.retired.push_back(retiredNode{ptr, reclaim});
+            std::size_t threshold = std::max<std::size_t>(64, 2 * numRecords.load(std::memory_order_relaxed));
+            if(state.retired.size() >= threshold) scan(state.retired);
+        }
+
+        template<typename T>
+        void retire(T* ptr) {
+            retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+        }
+
+        // reclaims everything left over - only valid once no other thread can hold a hazard (e.g. after all the workers have joined)
+        void reclaimAll() {
+            scan(local().retired);
+            std::lock_guard<std::mutex> guard(orphanLock);
+            for(retiredNode& node : orphans) node.reclaim(node.ptr);
+            orphans.clear();
+        }
+
+        // runs during static destruction, after the main thread's threadState has been destroyed (its retire list is in the orphans
+        // by then), so it must not go through local()
+        ~hazardDomain() {
+            for(retiredNode& node : orphans) node.reclaim(node.ptr);
+            hazardRecord* rec = records.load();
+            while(rec) delete std::exchange(rec, rec->next);
+        }
+};
+
+// RAII owner of one hazard slot of the current thread - while it protects a pointer, that node will not be reclaimed
+class hazardPointer {
+    private:
+        hazardRecord* rec;
+
+    public:
+        hazardPointer() {
+            auto& state = hazardDomain::global().local();
+            if(state.slotsInUse == hazardDomain::threadState::maxSlots) std::abort();
+            hazardRecord*& slot = state.slots[state.slotsInUse++];
+            if(!slot) slot = hazardDomain::global().acquireRecord();
+            rec = slot;
+        }
+
+        hazardPointer(const hazardPointer&) = delete;
+        hazardPointer& operator=(const hazardPointer&) = delete;
+
+        // loads 'src' and publishes it - the value is re-read after publishing, because the node could have been removed (and scanned)
+        // between the load and the store. once the two reads agree, the node was still reachable after it became hazardous
+        template<typename T>
+        T* protect(const std::atomic<T*>& src) {
+            T* ptr = src.load(std::memory_order_relaxed);
+            while(true) {
+                rec->ptr.store(ptr, std::memory_order_seq_cst);
+                T* again = src.load(std::memory_order_acquire);
+                if(again == ptr) return ptr;
+                ptr = again;
+            }
+        }
+
+        void reset() {
+            rec->ptr.store(nullptr, std::memory_order_release);
+        }
+
+        // slots are handed out like a stack, so they have to be released in the reverse order
+        ~hazardPointer() {
+            reset();
+            hazardDomain::global().local().slotsInUse--;
+        }
+};
+
+// deleter policy for uniquePtr - instead of deleting the resource straight away, it retires it to the hazard pointer domain, which
+// deletes it (through 'Deleter') once no reader can still be using it
+template<typename T, typename Deleter = defaultDelete<T>>
+struct hazardRetire {
+    void operator()(T* ptr) const {
+        hazardDomain::global().retire(ptr, [](void* p) { Deleter()(static_cast<T*>(p)); });
+    }
+};
+
+template<typename T>
+using hazardOwned = uniquePtr<T, hazardRetire<T>>;
+
+static_assert(sizeof(hazardOwned<int>) == sizeof(int*), "hazardRetire is stateless and must take no space");
+
+// counts live nodes, so that the stress test can check that every node was reclaimed
+static std::atomic<long> gLiveNodes(0);
+
+// Treiber stack - a lock-free stack where push and pop are a single compare-exchange on the head
+// without hazard pointers, pop would be unsafe: between reading head->next and the compare-exchange another thread could pop and free
+// the same node (use-after-free), or free it and have it allocated and pushed again (the ABA problem)
+template<typename T>
+class lockFreeStack {
+    private:
+        struct Node {
+            T value;
+            Node* next;
+            explicit Node(T v) : value(std::move(v)), next(nullptr) { gLiveNodes.fetch_add(1, std::memory_order_relaxed); }
+            ~Node() { gLiveNodes.fetch_sub(1, std::memory_order_relaxed); }
+        };
+
+        std::atomic<Node*> head{nullptr};
+
+    public:
+        void push(T value) {
+            Node* node = new Node(std::move(value));
+            node->next = head.load(std::memory_order_relaxed);
+            while(!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
+        bool pop(T& out) {
+            hazardPointer hp;
+            Node* top;
+            while(true) {
+                top = hp.protect(head);
+                if(!top) return false;
+                // safe to read, since 'top' cannot be reclaimed while it is protected
+                Node* next = top->next;
+                if(head.compare_exchange_weak(top, next, std::memory_order_acquire, std::memory_order_relaxed)) break;
+            }
+            hp.reset();
+            out = std::move(top->value);
+            // the node is unlinked now - handing it to a hazardOwned pointer retires it at the end of the scope
+            hazardOwned<Node> owner(top);
+            return true;
+        }
+
+        ~lockFreeStack() {
+            Node* node = head.load();
+            while(node) delete std::exchange(node, node->next);
+        }
+};
+
+int main(int argc, char* argv[]) {
+    int numThreads = argc > 1 ? std::atoi(argv[1]) : 16;
+    long totalNodes = argc > 2 ? std::atol(argv[2]) : 100000000;
+    long nodesPerThread = totalNodes / numThreads;
+
+    // stress test - every thread pushes and pops on the same stack, so popped nodes are constantly retired while other threads are
+    // still reading them. each thread keeps a few nodes on the stack so that pops rarely find it empty
+    lockFreeStack<long> stack;
+    std::atomic<long> popped(0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(int t=0; t<numThreads; t++) {
+        threads.emplace_back([&stack, &popped, nodesPerThread] {
+            long localPopped = 0, value;
+            for(long i=0; i<nodesPerThread; i++) {
+                stack.push(i);
+                if(i % 8 != 7 && stack.pop(value)) localPopped++;
+            }
+            while(stack.pop(value)) localPopped++;
+            popped.fetch_add(localPopped, std::memory_order_relaxed);
+        });
+    }
+    for(auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    long pending = gLiveNodes.load();
+    hazardDomain::global().reclaimAll();
+
+    std::cout << "threads: " << numThreads << ", nodes: " << nodesPerThread * numThreads << std::endl;
+    std::cout << "popped: " << popped.load() << " in " << elapsed.count() << " s ("
+              << popped.load() / elapsed.count() << " pops/sec)" << std::endl;
+    std::cout << "awaiting reclamation after join: " << pending << ", live nodes after reclaimAll: " << gLiveNodes.load() << std::endl;
+
+    return gLiveNodes.load() == 0 && popped.load() == nodesPerThread * numThreads ? 0 : 1;
+}
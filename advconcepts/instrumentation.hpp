@@ -0,0 +1,165 @@
+// header file for the instrumentation counters - constructions, copies, moves and bytes allocated (shared by advconcepts/ and stl/)
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <ostream>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// printing "copy constructor!" from every special member function shows what happens in a three line example, but the output cannot
+// be added up, and in a loop the printing costs far more than the copy it reports. instead, every instrumented type gets a set of
+// counters which the special member functions bump, and a program reads them through snapshots:
+// - snapshotOf<T>() returns the counters of T at this moment; subtracting two snapshots gives what happened in between
+// - counterScope<T> takes the first snapshot on construction, so 'scope.delta().copies == 0' checks that a path made no copies
+// - with INSTRUMENTATION_HOOK_NEW defined, the global operator new is replaced as well, and allocationSnapshot() counts every
+//   allocation of the program, whatever type it is for
+// the helper types 'A' of the stl/ demos derive from instrumented<A>, so the emplace demos there print a counterScope delta which
+// shows which constructor each insert or emplace ran
+// the counters are relaxed atomics - they only count, they never order other memory, so an increment is one uncontended add as long
+// as a single thread uses the type
+
+// the counters at one point in time
+struct counterSnapshot {
+    long constructions = 0;     // every constructor other than copy and move
+    long copies = 0;            // copy constructions and copy assignments
+    long moves = 0;             // move constructions and move assignments
+    long destructions = 0;
+    long bytesAllocated = 0;    // reported by the type itself through countAllocation()
+
+    counterSnapshot operator-(const counterSnapshot& rhs) const {
+        counterSnapshot diff;
+        diff.constructions = constructions - rhs.constructions;
+        diff.copies = copies - rhs.copies;
+        diff.moves = moves - rhs.moves;
+        diff.destructions = destructions - rhs.destructions;
+        diff.bytesAllocated = bytesAllocated - rhs.bytesAllocated;
+        return diff;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const counterSnapshot& snap) {
+    return os << snap.constructions << " constructions, " << snap.copies << " copies, " << snap.moves << " moves, "
+              << snap.destructions << " destructions, " << snap.bytesAllocated << " bytes allocated";
+}
+
+// the live counters of one type
+struct typeCounters {
+    std::atomic<long> constructions{0};
+    std::atomic<long> copies{0};
+    std::atomic<long> moves{0};
+    std::atomic<long> destructions{0};
+    std::atomic<long> bytesAllocated{0};
+
+    counterSnapshot snapshot() const {
+        counterSnapshot snap;
+        snap.constructions = constructions.load(std::memory_order_relaxed);
+        snap.copies = copies.load(std::memory_order_relaxed);
+        snap.moves = moves.load(std::memory_order_relaxed);
+        snap.destructions = destructions.load(std::memory_order_relaxed);
+        snap.bytesAllocated = bytesAllocated.load(std::memory_order_relaxed);
+        return snap;
+    }
+};
+
+// one set of counters per type - a function-local static, so including the header is all a program has to do
+template<typename T>
+typeCounters& countersOf() {
+    static typeCounters counters;
+    return counters;
+}
+
+template<typename T>
+counterSnapshot snapshotOf() {
+    return countersOf<T>().snapshot();
+}
+
+// CRTP base which counts the special member functions of 'Derived'. defaulted members of the derived class call these automatically;
+// hand-written ones have to call them like they would for any other base class, e.g. Collection(const Collection& other) :
+// instrumented(other) - otherwise a copy is counted as a construction
+template<typename Derived>
+class instrumented {
+    private:
+        static typeCounters& counters() { return countersOf<Derived>(); }
+
+    protected:
+        instrumented() noexcept { counters().constructions.fetch_add(1, std::memory_order_relaxed); }
+        instrumented(const instrumented&) noexcept { counters().copies.fetch_add(1, std::memory_order_relaxed); }
+        instrumented(instrumented&&) noexcept { counters().moves.fetch_add(1, std::memory_order_relaxed); }
+        ~instrumented() { counters().destructions.fetch_add(1, std::memory_order_relaxed); }
+
+        instrumented& operator=(const instrumented&) noexcept {
+            counters().copies.fetch_add(1, std::memory_order_relaxed);
+            return *this;
+        }
+
+        instrumented& operator=(instrumented&&) noexcept {
+            counters().moves.fetch_add(1, std::memory_order_relaxed);
+            return *this;
+        }
+
+        // called by the derived class for the memory it allocates itself (its array, its buffer...)
+        static void countAllocation(std::size_t bytes) noexcept {
+            counters().bytesAllocated.fetch_add(long(bytes), std::memory_order_relaxed);
+        }
+};
+
+// snapshot taken on construction - delta() is what happened to T since then
+template<typename T>
+class counterScope {
+    private:
+        counterSnapshot start;
+
+    public:
+        counterScope() : start(snapshotOf<T>()) {}
+        counterSnapshot delta() const { return snapshotOf<T>() - start; }
+};
+
+// global allocation counters - only fed when the program defines INSTRUMENTATION_HOOK_NEW before including this header
+struct allocationCounts {
+    long allocations = 0;
+    long bytes = 0;
+
+    allocationCounts operator-(const allocationCounts& rhs) const {
+        allocationCounts diff;
+        diff.allocations = allocations - rhs.allocations;
+        diff.bytes = bytes - rhs.bytes;
+        return diff;
+    }
+};
+
+inline std::atomic<long>& globalAllocations() {
+    static std::atomic<long> count(0);
+    return count;
+}
+
+inline std::atomic<long>& globalBytesAllocated() {
+    static std::atomic<long> bytes(0);
+    return bytes;
+}
+
+inline allocationCounts allocationSnapshot() {
+    allocationCounts snap;
+    snap.allocations = globalAllocations().load(std::memory_order_relaxed);
+    snap.bytes = globalBytesAllocated().load(std::memory_order_relaxed);
+    return snap;
+}
+
+// the hook - a replaced operator new has to be defined exactly once per program, so only one translation unit may define the macro
+// (every program in advconcepts/ and stl/ is a single file). the array forms and the sized deletes forward here by default
+// all of them are kept out of line - inlined into library code, GCC pairs the malloc() and free() it can see behind them and warns
+// about a mismatch (-Wmismatched-new-delete) that is not there
+#ifdef INSTRUMENTATION_HOOK_NEW
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    globalAllocations().fetch_add(1, std::memory_order_relaxed);
+    globalBytesAllocated().fetch_add(long(size), std::memory_order_relaxed);
+    if(void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { std::free(ptr); }
+__attribute__((noinline)) void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+#endif
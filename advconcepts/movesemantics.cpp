@@ -1,6 +1,12 @@
 // move semantics in CPP
 #include <iostream>
 #include <string>
+#include <memory_resource>
+#include <atomic>
+#include <new>
+#include <chrono>
+#include <cstdlib>
+#include "instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -19,89 +25,280 @@
 // helps us in performing "efficient transfer" of resources from source to destination - by itself it does not perform any moving
 
 // an example class with dynamic memory allocation to demonstrate move semantics
-class Collection {
+// it remembers its element count (the copy operations need it - sizeof(other) is the size of the Collection object, not of its array),
+// and takes its memory from a std::pmr::memory_resource, the regular heap unless an arena or pool is passed in
+// its special member functions are counted through the instrumented base (instrumentation.hpp), so main() can check how many copies
+// and moves each statement made instead of reading printed messages
+class Collection : instrumented<Collection> {
     private: 
         int* data;
+        int size;
+        std::pmr::memory_resource* resource;
+
+        int* allocate(int n) {
+            countAllocation(n * sizeof(int));
+            return n ? static_cast<int*>(resource->allocate(n * sizeof(int), alignof(int))) : nullptr;
+        }
+
+        void deallocate() {
+            if(data) resource->deallocate(data, size * sizeof(int), alignof(int));
+        }
     
     public: 
         // default constructor which delegates the parameterised constructor
-        Collection() : Collection(0) {
-            std::cout << "default constructor!" << std::endl;
-        }
+        Collection() : Collection(0) {}
 
         // constructor with the explicit keyword - making sure it has to be called and there is no implicit (unwanted) data conversion taking place
-        explicit Collection(int size) {
-            data = new int[size];
-            std::cout << "constructor!" << std::endl;
+        explicit Collection(int n, std::pmr::memory_resource* res = std::pmr::get_default_resource()) : size(n), resource(res) {
+            data = allocate(size);
         }   
 
         // copy constructor with const lvalue reference
-        Collection(const Collection& other) {
-            std::cout << "copy constructor!" << std::endl;
-            data = new int[sizeof(other)];
-            std::copy(other.data, other.data + sizeof(other), data);
+        // like the std::pmr containers, the copy does not inherit the memory resource of 'other' (it would be tied to the lifetime of
+        // somebody else's arena) but uses the default one
+        Collection(const Collection& other) : instrumented(other), size(other.size), resource(std::pmr::get_default_resource()) {
+            data = allocate(size);
+            std::copy(other.data, other.data + size, data);
         }   
 
-        //  copy assignment operator with const lvalue reference
+        //  copy assignment operator with const lvalue reference - keeps our own memory resource
+        // the copy is made into a new array before the old one is given back, so if the allocation throws this object is unchanged
+        // (copy-swap would not do here: the copy constructor switches to the default memory resource)
         Collection& operator=(const Collection& other) {
             if(this != &other) {
-                std::cout << "copy assignment!" << std::endl;
-                delete[] data;
-                data = new int[sizeof(other)];
-                std::copy(other.data, other.data + sizeof(other), data);    
+                int* copy = allocate(other.size);
+                std::copy(other.data, other.data + other.size, copy);
+                instrumented::operator=(other);
+                deallocate();
+                data = copy;
+                size = other.size;
             }
             return *this;
         }
 
-        // move constructor
-        Collection(Collection&& other) noexcept {
-            std::cout << "move constructor!" << std::endl;
-            data = other.data;
+        // move constructor - the array is stolen, so the memory resource it came from comes along
+        Collection(Collection&& other) noexcept : instrumented(std::move(other)), data(other.data), size(other.size), resource(other.resource) {
             other.data = nullptr;
+            other.size = 0;
         }
 
-        // move assignment operator
-        Collection& operator=(Collection&& other) noexcept {
+        // move assignment operator - the array can only be stolen if both sides use the same memory resource, since we will be the one
+        // giving it back. otherwise the elements have to be copied into our own memory (which can throw, so this one is not noexcept)
+        Collection& operator=(Collection&& other) {
             if(this != &other) {
-                std::cout << "move assignment!" << std::endl;
-                delete[] data;
-                data = other.data;
-                other.data = nullptr;
+                if(resource->is_equal(*other.resource)) {
+                    instrumented::operator=(std::move(other));
+                    deallocate();
+                    data = other.data;
+                    size = other.size;
+                    other.data = nullptr;
+                    other.size = 0;
+                } else {
+                    *this = static_cast<const Collection&>(other);
+                }
             }
             return *this;
         }
 
+        int& operator[](std::size_t idx) { return data[idx]; }
+        const int& operator[](std::size_t idx) const { return data[idx]; }
+        void set(std::size_t idx, int value) { data[idx] = value; }
+
+        int getSize() const { return size; }
+
         // destructor
         ~Collection() {
-            std::cout << "destructor!" << std::endl;
-            delete[] data;
+            deallocate();
+        }
+};
+
+
+
+// copy-on-write Collection - for taking cheap read-only snapshots
+// a copy does not duplicate the array, it shares it and bumps a reference count stored in front of the elements. only when somebody
+// writes through a shared array does the writer take a private copy ('detach'), so snapshots which are only read never copy anything
+// copies and destructions may happen on different threads, so the count is atomic (same ordering rules as sharedPtr)
+class CowCollection : instrumented<CowCollection> {
+    private:
+        // header allocated in front of the elements, in the same block
+        struct buffer {
+            std::atomic<long> refs;
+            int size;
+            std::pmr::memory_resource* resource;
+
+            int* elements() { return reinterpret_cast<int*>(this + 1); }
+
+            // the header is constructed in the raw block (the ints after it need no construction), so that release() destroys an
+            // object which really exists
+            static buffer* create(int n, std::pmr::memory_resource* res) {
+                void* raw = res->allocate(sizeof(buffer) + n * sizeof(int), alignof(buffer));
+                return ::new (raw) buffer{1, n, res};
+            }
+
+            void release() {
+                if(refs.fetch_sub(1, std::memory_order_release) == 1) {
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    std::pmr::memory_resource* res = resource;
+                    int n = size;
+                    this->~buffer();
+                    res->deallocate(this, sizeof(buffer) + n * sizeof(int), alignof(buffer));
+                }
+            }
+        };
+
+        buffer* buf;
+
+        static buffer* createBuffer(int n, std::pmr::memory_resource* res) {
+            countAllocation(sizeof(buffer) + n * sizeof(int));
+            return buffer::create(n, res);
+        }
+
+        // gives this object a private copy of the array if it is shared with anybody else
+        void detach() {
+            if(!buf || buf->refs.load(std::memory_order_acquire) == 1) return;
+            buffer* copy = createBuffer(buf->size, buf->resource);
+            std::copy(buf->elements(), buf->elements() + buf->size, copy->elements());
+            buf->release();
+            buf = copy;
+        }
+
+    public:
+        explicit CowCollection(int n = 0, std::pmr::memory_resource* res = std::pmr::get_default_resource()) : buf(createBuffer(n, res)) {}
+
+        // a copy only shares the buffer
+        CowCollection(const CowCollection& other) : instrumented(other), buf(other.buf) {
+            if(buf) buf->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // leaves 'other' without a buffer - a moved-from CowCollection is empty, and can still be copied, assigned and destroyed
+        CowCollection(CowCollection&& other) noexcept : instrumented(std::move(other)), buf(other.buf) {
+            other.buf = nullptr;
+        }
+
+        // by-value assignment with copy-swap - both the copy and the move are cheap here
+        CowCollection& operator=(CowCollection other) noexcept {
+            instrumented::operator=(std::move(other));
+            std::swap(buf, other.buf);
+            return *this;
+        }
+
+        ~CowCollection() {
+            if(buf) buf->release();
+        }
+
+        // writing access - detaches first, so the other holders of the array never see the change. there is no writable operator[]:
+        // a returned int& would outlive the detach, and a copy taken afterwards would share the array the reference still writes to
+        void set(std::size_t idx, int value) {
+            detach();
+            buf->elements()[idx] = value;
         }
+
+        // reading access never copies
+        const int& operator[](std::size_t idx) const { return buf->elements()[idx]; }
+
+        int getSize() const { return buf ? buf->size : 0; }
+        long useCount() const { return buf ? buf->refs.load(std::memory_order_relaxed) : 0; }
 };
 
+// snapshot-heavy workload - a request handler snapshots a large Collection, reads a few values from the snapshot, and every
+// 'writeEvery'th request modifies its snapshot. the bytes copied are the bytes the snapshots allocated: an eager copy allocates its
+// array when it is taken, a copy-on-write one only when it is written to while it still shares the array
+// a failed check is reported and makes main() return 1 - unlike assert, it is not compiled away with -DNDEBUG
+bool expect(bool condition, const char* what) {
+    if(!condition) std::cerr << "check failed: " << what << std::endl;
+    return condition;
+}
+
+template<typename CollectionType>
+bool benchmarkSnapshots(const char* name, int size, long requests, long writeEvery) {
+    CollectionType live(size);
+    for(int i=0; i<size; i++) live.set(i, i);
+    const CollectionType& liveView = live;
 
+    counterScope<CollectionType> scope;
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(long r=0; r<requests; r++) {
+        CollectionType snapshot = liveView;
+        const CollectionType& readOnly = snapshot;
+        sum += readOnly[r % size] + readOnly[(r * 7) % size];
+        if(r % writeEvery == 0) {
+            snapshot.set(0, int(r));
+            sum += snapshot[0];
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    asm volatile("" : : "r"(sum));
+    counterSnapshot counted = scope.delta();
+    std::cout << name << counted.bytesAllocated << " bytes copied, " << elapsed.count() / requests << " ns per request" << std::endl;
+    return expect(counted.copies == requests, "every snapshot counts as one copy");
+}
+
+// runs one statement and prints what it did to Collection
+template<typename Statement>
+counterSnapshot counted(const char* name, Statement statement) {
+    counterScope<Collection> scope;
+    statement();
+    counterSnapshot delta = scope.delta();
+    std::cout << name << delta << std::endl;
+    return delta;
+}
 
-int main() {
+int main(int argc, char* argv[]) {
     // regular object creation
     Collection c1(7);
-    std::cout << std::endl;
-
-    // copy constructors
     Collection c2(8);
-    Collection c3 = c2;
-    std::cout << std::endl;
+    Collection c3(0), c4, c5(0);
+
+    // copy constructor
+    counterSnapshot copyConstruct = counted("copy constructor : ", [&] { Collection copy = c2; });
+    bool ok = expect(copyConstruct.copies == 1, "the copy constructor copies once");
 
     // copy assignment
-    Collection c4;  
-    c4 = c1;
-    std::cout << std::endl;
+    counted("copy assignment  : ", [&] { c4 = c1; });
+
+    // move constructor - steals the array, so it must not copy or allocate anything
+    counterSnapshot moveConstruct = counted("move constructor : ", [&] { Collection stolen(std::move(c2)); });
+    ok = expect(moveConstruct.copies == 0 && moveConstruct.bytesAllocated == 0, "the move constructor neither copies nor allocates") && ok;
+
+    // move assignment - same memory resource on both sides, so again no copy
+    counterSnapshot moveAssign = counted("move assignment  : ", [&] { c5 = std::move(c1); });
+    ok = expect(moveAssign.copies == 0 && moveAssign.bytesAllocated == 0, "move assignment neither copies nor allocates") && ok;
+
+    // move assignment across memory resources - falls back to a copy
+    std::pmr::monotonic_buffer_resource arena;
+    Collection inArena(16, &arena);
+    counterSnapshot crossResource = counted("move, other arena: ", [&] { c3 = std::move(inArena); });
+    ok = expect(crossResource.copies == 1, "move assignment across memory resources copies") && ok;
+
+    // copy assignment into an arena with no room left - the allocation throws, and the target keeps its old array
+    char fixedBuffer[64];
+    std::pmr::monotonic_buffer_resource fixedArena(fixedBuffer, sizeof(fixedBuffer), std::pmr::null_memory_resource());
+    Collection small(4, &fixedArena);
+    small.set(0, 42);
+    bool threw = false;
+    try {
+        small = Collection(64);
+    } catch(const std::bad_alloc&) {
+        threw = true;
+    }
+    ok = expect(threw && small.getSize() == 4 && small[0] == 42, "a failed copy assignment leaves the target unchanged") && ok;
 
-    // move constructor
-    Collection c5(std::move(c2));
-    std::cout << std::endl;
+    // snapshots of a 4096-element Collection, one in 100 of them written to
+    long requests = argc > 1 ? std::atol(argv[1]) : 100000;
+    ok = benchmarkSnapshots<Collection>("eager copy    : ", 4096, requests, 100) && ok;
+    ok = benchmarkSnapshots<CowCollection>("copy-on-write : ", 4096, requests, 100) && ok;
 
-    // move assignment
-    c5 = std::move(c1);
-    std::cout << std::endl;
+    // a write after a snapshot stays private to the writer, and a moved-from CowCollection is empty but still usable
+    CowCollection original(4);
+    original.set(0, 1);
+    CowCollection snap = original;
+    original.set(0, 5);
+    ok = expect(snap[0] == 1 && original[0] == 5 && snap.useCount() == 1, "a write after a snapshot stays private") && ok;
+    CowCollection taken(std::move(original));
+    CowCollection copyOfEmpty = original;
+    ok = expect(original.getSize() == 0 && original.useCount() == 0 && copyOfEmpty.getSize() == 0 && taken[0] == 5,
+                "a moved-from CowCollection is empty and still usable") && ok;
 
-    return 0;
-}
\ No newline at end of file
+    return ok ? 0 : 1;
+}
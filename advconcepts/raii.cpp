@@ -1,5 +1,10 @@
 // RAII concept in CPP
 #include <iostream>
+#include <memory_resource>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <cstdlib>
 
 /*
     IMPORTANT LINKS: 
@@ -17,15 +22,23 @@
 // has lifetime that is bounded by the lifetime of an automatic or temporary object
 
 // now creating a class 'Collection' in order to handle this dynamically allocated resource using the RAII technique
+// the memory comes from a std::pmr::memory_resource (a polymorphic allocator) - by default the regular heap, but a batch of Collections
+// can also be given an arena, which hands memory out with a pointer bump and frees all of it at once
 class Collection {
     int* data;  
     int size;   
+    std::pmr::memory_resource* resource;
     public: 
-    Collection() {
-        size = 100;
-        data = new int[100];
+    Collection() : Collection(100) {}
+
+    explicit Collection(int n, std::pmr::memory_resource* res = std::pmr::get_default_resource()) : size(n), resource(res) {
+        data = static_cast<int*>(resource->allocate(size * sizeof(int), alignof(int)));
     }
 
+    // copying would make two objects own the same array (and free it twice), so this class is not copyable
+    Collection(const Collection&) = delete;
+    Collection& operator=(const Collection&) = delete;
+
     // overloading the indexing operators
     int& operator[](std::size_t idx) {
         return data[idx];
@@ -36,8 +49,8 @@ class Collection {
     }
 
     ~Collection() {
+        resource->deallocate(data, size * sizeof(int), alignof(int));
         size = -1;
-        delete[] data;
     }
 };
 
@@ -65,7 +78,23 @@ void manipulateArray(int* arr, int size) {
     }
 }
 
-int main() {
+// build and destroy benchmark - creates 'count' Collections of 16 ints, destroys them, and repeats. with the default resource every
+// Collection is a malloc and a free; with the arena the allocations are pointer bumps, deallocate does nothing, and release() gives all
+// the memory of the cycle back in one go
+void benchmarkCollections(const char* name, long count, std::pmr::memory_resource* resource, std::pmr::monotonic_buffer_resource* arena) {
+    constexpr int cycles = 5;
+    std::vector<std::optional<Collection>> slots(count);
+    auto start = std::chrono::steady_clock::now();
+    for(int c=0; c<cycles; c++) {
+        for(long i=0; i<count; i++) slots[i].emplace(16, resource);
+        for(long i=0; i<count; i++) slots[i].reset();
+        if(arena) arena->release();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << elapsed.count() / (cycles * count) << " ns per Collection" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
     /* 
     // allocating memory without using RAII technique
     int* arr = new int[100];
@@ -97,5 +126,11 @@ int main() {
         std::cerr << "Exception occurred: " << e.what() << std::endl;
     }
 
+    // 1M Collections per cycle by default
+    long count = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::pmr::monotonic_buffer_resource arena;
+    benchmarkCollections("heap  : ", count, std::pmr::get_default_resource(), nullptr);
+    benchmarkCollections("arena : ", count, &arena, &arena);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,171 @@
+// segmented vector - a vector made of fixed-size chunks, which never moves its elements
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <new>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+// compile with: g++ -std=c++17 -O2 segmentedvector.cpp -o segmentedvector
+// run with:     ./segmentedvector [elements]
+
+// a contiguous vector (std::vector, or the NaiveVector family in copyswaprules.cpp) grows by allocating a bigger buffer and moving all
+// the elements over. this is amortised O(1), but:
+// 1. the push_back which triggers the growth copies the whole buffer - on a large vector that is one very slow push_back (latency spike)
+// 2. every pointer, reference and iterator into the vector is invalidated
+// a segmented vector stores its elements in fixed-size chunks instead, plus an index table with one pointer per chunk. growing only
+// allocates a new chunk and appends its pointer to the table, so elements never move:
+// - element i lives in chunk i / ChunkSize at offset i % ChunkSize - with a power of two chunk size that is a shift and a mask, O(1)
+// - the index table still grows geometrically, but it only holds one pointer per chunk, so copying it is ChunkSize times cheaper
+// - pointers and references to elements stay valid on push_back, and so do iterators (they store an index, not a pointer)
+template<typename T, size_t ChunkSize = 1024>
+class SegmentedVector {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    private:
+        std::vector<T*> mChunks;
+        size_t mSize;
+
+        static T* allocateChunk() { return static_cast<T*>(::operator new(ChunkSize * sizeof(T))); }
+
+    public:
+        // the iterator remembers the vector and an index, so it survives the index table being reallocated by a push_back
+        class iterator {
+            private:
+                SegmentedVector* mVec;
+                size_t mIdx;
+
+            public:
+                iterator(SegmentedVector* vec, size_t idx) : mVec(vec), mIdx(idx) {}
+                T& operator*() const { return (*mVec)[mIdx]; }
+                T* operator->() const { return &(*mVec)[mIdx]; }
+                iterator& operator++() { mIdx++; return *this; }
+                bool operator==(const iterator& rhs) const { return mIdx == rhs.mIdx; }
+                bool operator!=(const iterator& rhs) const { return mIdx != rhs.mIdx; }
+        };
+
+        // read-only traversal used by the copy constructor
+        class const_iterator {
+            private:
+                const SegmentedVector* mVec;
+                size_t mIdx;
+
+            public:
+                const_iterator(const SegmentedVector* vec, size_t idx) : mVec(vec), mIdx(idx) {}
+                const T& operator*() const { return (*mVec)[mIdx]; }
+                const_iterator& operator++() { mIdx++; return *this; }
+                bool operator!=(const const_iterator& rhs) const { return mIdx != rhs.mIdx; }
+        };
+
+        void swap(SegmentedVector& rhs) noexcept {
+            using std::swap;
+            swap(mChunks, rhs.mChunks);
+            swap(mSize, rhs.mSize);
+        }
+
+        SegmentedVector() : mSize(0) {}
+
+        // copy constructor - copies chunk by chunk (on failure the destructor of the partially built copy cleans up)
+        SegmentedVector(const SegmentedVector& rhs) : SegmentedVector() {
+            mChunks.reserve(rhs.mChunks.size());
+            for(const T& value : rhs) push_back(value);
+        }
+
+        // move constructor - steals the index table, so no chunk is touched
+        SegmentedVector(SegmentedVector&& rhs) noexcept : mChunks(std::move(rhs.mChunks)), mSize(std::exchange(rhs.mSize, 0)) {}
+
+        // by-value assignment with copy-swap, as in NaiveVectorFinal
+        SegmentedVector& operator=(SegmentedVector rhs) noexcept {
+            rhs.swap(*this);
+            return *this;
+        }
+
+        ~SegmentedVector() {
+            clear();
+            for(T* chunk : mChunks) ::operator delete(chunk);
+        }
+
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            size_t chunk = mSize / ChunkSize;
+            // the index table can throw while it grows - the new chunk is freed then, as nothing refers to it yet
+            if(chunk == mChunks.size()) {
+                T* fresh = allocateChunk();
+                try {
+                    mChunks.push_back(fresh);
+                } catch(...) {
+                    ::operator delete(fresh);
+                    throw;
+                }
+            }
+            T* slot = ::new (static_cast<void*>(mChunks[chunk] + mSize % ChunkSize)) T(std::forward<Args>(args)...);
+            mSize++;
+            return *slot;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() {
+            mSize--;
+            mChunks[mSize / ChunkSize][mSize % ChunkSize].~T();
+        }
+
+        // destroys the elements but keeps the chunks around for reuse
+        void clear() {
+            while(mSize) pop_back();
+        }
+
+        T& operator[](size_t idx) { return mChunks[idx / ChunkSize][idx % ChunkSize]; }
+        const T& operator[](size_t idx) const { return mChunks[idx / ChunkSize][idx % ChunkSize]; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, mSize); }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, mSize); }
+
+        size_t size() const { return mSize; }
+        size_t chunks() const { return mChunks.size(); }
+};
+
+// measures every single push_back while building an n-element vector, and reports the percentiles of the distribution - the average
+// hides the growth spikes of a contiguous vector, the tail (p99.9, max) shows them
+template<typename Vector>
+void pushBackLatency(const char* name, size_t n) {
+    std::vector<std::uint32_t> samples(n);
+    Vector v;
+    auto total = std::chrono::steady_clock::now();
+    for(size_t i=0; i<n; i++) {
+        auto start = std::chrono::steady_clock::now();
+        v.push_back(int(i));
+        samples[i] = std::uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - total;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) { return samples[std::min(samples.size() - 1, size_t(p * samples.size()))]; };
+    std::cout << name << "p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99) << " ns, p99.9 " << percentile(0.999)
+              << " ns, max " << samples.back() << " ns, total " << elapsed.count() << " s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    // references and iterators stay valid while the vector grows
+    SegmentedVector<int, 4> v;
+    v.push_back(1);
+    int& first = v[0];
+    auto it = v.begin();
+    for(int i=2; i<=100; i++) v.push_back(i);
+    first += 1000;
+    std::cout << "first element: " << *it << ", size: " << v.size() << ", chunks: " << v.chunks() << std::endl;
+
+    // push_back latency distribution, segmented against contiguous growth
+    pushBackLatency<SegmentedVector<int>>("SegmentedVector<int> : ", n);
+    pushBackLatency<std::vector<int>>("std::vector<int>     : ", n);
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+// small buffer optimisation - a vector which keeps its first few elements inline
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <type_traits>
+#include <new>
+#include <chrono>
+#include <cstdlib>
+
+// counts every allocation of the program through the hook in instrumentation.hpp, so the benchmark can report allocations per vector
+#define INSTRUMENTATION_HOOK_NEW
+#include "instrumentation.hpp"
+
+// compile with: g++ -std=c++17 -O2 smallvector.cpp -o smallvector
+
+// most vectors in a program are small - a handful of elements which live only for one request. a heap-allocating vector like
+// NaiveVectorFinal (copyswaprules.cpp) pays one allocation (and a cache miss on a different memory block) for each of them
+// the small buffer optimisation gives the vector an inline buffer with room for N elements inside the object itself. it only goes to
+// the heap once it holds more than N elements, exactly like std::string does for short strings
+
+// the class follows the same rule of five / copy-swap structure as the NaiveVector family, but moving is more involved: a heap buffer
+// can be stolen with a pointer swap, while inline elements live inside the source object and have to be moved one by one
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+    private:
+        static constexpr bool nothrowMove = std::is_nothrow_move_constructible<T>::value;
+
+        T* mPtr;            // points either to mInline or to a heap buffer
+        size_t mSize;
+        size_t mCapacity;
+        alignas(T) unsigned char mInline[N * sizeof(T)];
+
+        T* inlineData() { return reinterpret_cast<T*>(mInline); }
+        bool isInline() const { return mPtr == reinterpret_cast<const T*>(mInline); }
+
+        // destroys the elements and frees the heap buffer (if any), leaving an empty vector with the inline buffer
+        void destroyAll() {
+            std::destroy(mPtr, mPtr + mSize);
+            if(!isInline()) ::operator delete(mPtr);
+            mPtr = inlineData();
+            mSize = 0;
+            mCapacity = N;
+        }
+
+        // takes over the contents of 'rhs', which must be empty - a heap buffer is stolen, inline elements are moved across
+        void stealFrom(SmallVector& rhs) noexcept(nothrowMove) {
+            if(rhs.isInline()) {
+                std::uninitialized_move(rhs.mPtr, rhs.mPtr + rhs.mSize, mPtr);
+                mSize = rhs.mSize;
+                std::destroy(rhs.mPtr, rhs.mPtr + rhs.mSize);
+            } else {
+                mPtr = rhs.mPtr;
+                mSize = rhs.mSize;
+                mCapacity = rhs.mCapacity;
+                rhs.mPtr = rhs.inlineData();
+                rhs.mCapacity = N;
+            }
+            rhs.mSize = 0;
+        }
+
+        // fills a new buffer with the elements - moved if that cannot throw (or T cannot be copied), copied otherwise, like std::vector
+        // does. either way a throwing constructor destroys what was already built and leaves our own elements untouched
+        void relocateInto(T* newPtr) {
+            if constexpr(nothrowMove || !std::is_copy_constructible<T>::value) {
+                std::uninitialized_move(mPtr, mPtr + mSize, newPtr);
+            } else {
+                std::uninitialized_copy(mPtr, mPtr + mSize, newPtr);
+            }
+        }
+
+        // switches to a filled new buffer - destroys the old elements and frees the old heap buffer (never the inline one)
+        void adopt(T* newPtr, size_t newCapacity) {
+            std::destroy(mPtr, mPtr + mSize);
+            if(!isInline()) ::operator delete(mPtr);
+            mPtr = newPtr;
+            mCapacity = newCapacity;
+        }
+
+    public:
+        SmallVector() : mPtr(inlineData()), mSize(0), mCapacity(N) {}
+
+        // copy constructor - the copy only goes to the heap if the elements do not fit inline
+        SmallVector(const SmallVector& rhs) : SmallVector() {
+            reserve(rhs.mSize);
+            std::uninitialized_copy(rhs.mPtr, rhs.mPtr + rhs.mSize, mPtr);
+            mSize = rhs.mSize;
+        }
+
+        // move constructor - noexcept, as long as moving a T cannot throw, so that containers of SmallVector move them when growing
+        SmallVector(SmallVector&& rhs) noexcept(nothrowMove) : SmallVector() {
+            stealFrom(rhs);
+        }
+
+        // copy assignment - copy first, then move the copy in, so a failing copy leaves *this untouched
+        SmallVector& operator=(const SmallVector& rhs) {
+            if(this != &rhs) {
+                SmallVector copy(rhs);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        // move assignment - releases our own contents first, then takes over the contents of 'rhs'
+        SmallVector& operator=(SmallVector&& rhs) noexcept(nothrowMove) {
+            if(this != &rhs) {
+                destroyAll();
+                stealFrom(rhs);
+            }
+            return *this;
+        }
+
+        // a plain pointer swap is not possible when either side is inline, so swap goes through three moves
+        void swap(SmallVector& rhs) noexcept(nothrowMove) {
+            SmallVector tmp(std::move(rhs));
+            rhs = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        ~SmallVector() {
+            destroyAll();
+        }
+
+        // grows into a heap buffer - the elements are moved over, and the old heap buffer (never the inline one) is freed
+        void reserve(size_t newCapacity) {
+            if(newCapacity <= mCapacity) return;
+            T* newPtr = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+            try {
+                relocateInto(newPtr);
+            } catch(...) {
+                ::operator delete(newPtr);
+                throw;
+            }
+            adopt(newPtr, newCapacity);
+        }
+
+        // when the vector is full the new element is constructed in the new buffer first, and only then are the old elements moved:
+        // 'args' may refer to one of them (v.push_back(v[0])), which must still be there, unmoved, while the new element is built
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            if(mSize < mCapacity) {
+                T* slot = ::new (static_cast<void*>(mPtr + mSize)) T(std::forward<Args>(args)...);
+                mSize++;
+                return *slot;
+            }
+            size_t newCapacity = 2 * mCapacity;
+            T* newPtr = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+            T* slot = nullptr;
+            try {
+                slot = ::new (static_cast<void*>(newPtr + mSize)) T(std::forward<Args>(args)...);
+                relocateInto(newPtr);
+            } catch(...) {
+                if(slot) slot->~T();
+                ::operator delete(newPtr);
+                throw;
+            }
+            adopt(newPtr, newCapacity);
+            mSize++;
+            return *slot;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() {
+            mPtr[--mSize].~T();
+        }
+
+        void clear() {
+            std::destroy(mPtr, mPtr + mSize);
+            mSize = 0;
+        }
+
+        T& operator[](size_t idx) { return mPtr[idx]; }
+        const T& operator[](size_t idx) const { return mPtr[idx]; }
+
+        T* begin() { return mPtr; }
+        T* end() { return mPtr + mSize; }
+        const T* begin() const { return mPtr; }
+        const T* end() const { return mPtr + mSize; }
+
+        size_t size() const { return mSize; }
+        size_t capacity() const { return mCapacity; }
+        bool onHeap() const { return !isInline(); }
+};
+
+// builds and destroys 'repeats' vectors of 'n' ints, and reports allocations and nanoseconds per vector
+template<typename Vector>
+void buildVectors(const char* name, size_t n, long repeats) {
+    allocationCounts before = allocationSnapshot();
+    auto start = std::chrono::steady_clock::now();
+    for(long r=0; r<repeats; r++) {
+        Vector v;
+        for(size_t i=0; i<n; i++) v.push_back(int(i));
+        asm volatile("" : : "r"(&v) : "memory");
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << double((allocationSnapshot() - before).allocations) / repeats << " allocations, "
+              << elapsed.count() / repeats << " ns per vector" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    long repeats = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    // moves between the inline and heap states
+    SmallVector<std::string, 2> a;
+    a.push_back("inline one");
+    a.push_back("inline two");
+    SmallVector<std::string, 2> b = std::move(a);     // inline elements moved one by one
+    b.push_back("now on the heap");
+    SmallVector<std::string, 2> c = std::move(b);     // heap buffer stolen
+    c.swap(a);
+    std::cout << "a: " << a.size() << " elements, on heap: " << std::boolalpha << a.onHeap() << std::endl;
+    std::cout << "c: " << c.size() << " elements, on heap: " << c.onHeap() << std::endl;
+
+    // pushing one of its own elements into a full vector - the copy is made before the element moves to the new buffer
+    SmallVector<std::string, 2> d;
+    d.push_back("first element, long enough to live on the heap");
+    d.push_back("second");
+    d.push_back(d[0]);
+    std::cout << "d[2]: " << d[2] << std::endl;
+
+    // allocations and latency for vectors of 0 to 64 ints, inline capacity of 16
+    for(size_t n : {0, 1, 4, 8, 16, 17, 32, 64}) {
+        std::cout << n << " elements" << std::endl;
+        buildVectors<SmallVector<int, 16>>("SmallVector<int, 16> : ", n, repeats);
+        buildVectors<std::vector<int>>("std::vector<int>     : ", n, repeats);
+    }
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+// benchmarks for the smart pointer implementations in smartpointersimpl.hpp
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <new>
+#include "smartpointersimpl.hpp"
+
+// counts every allocation of the program through the hook in instrumentation.hpp, so the benchmarks can report allocations per operation
+#define INSTRUMENTATION_HOOK_NEW
+#include "instrumentation.hpp"
+
+// compile with: g++ -std=c++17 -O2 -pthread smartpointersbench.cpp -o smartpointersbench
+// run with:     ./smartpointersbench [threads] [copies per thread] [list nodes]
+
+// a small payload, roughly the size of the objects we usually share
+struct Payload {
+    long values[4];
+    explicit Payload(long v) : values{v, v, v, v} {}
+};
+
+// contention benchmark - every thread repeatedly copies the same shared pointer and destroys the copy, so all the threads hammer the
+// same reference count. the result is reported as copies per second, summed over all the threads
+template<typename Ptr>
+double copiesPerSecond(const Ptr& source, int numThreads, long copiesPerThread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(int t=0; t<numThreads; t++) {
+        threads.emplace_back([&source, copiesPerThread] {
+            for(long i=0; i<copiesPerThread; i++) {
+                Ptr copy(source);
+                // keep the compiler from removing the copy altogether
+                asm volatile("" : : "r"(copy.get()) : "memory");
+            }
+        });
+    }
+    for(auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return numThreads * copiesPerThread / elapsed.count();
+}
+
+// nodes of a singly linked list, once linked through sharedPtr (count in a separate control block) and once through intrusivePtr
+// (count embedded in the node)
+struct SharedNode {
+    long value;
+    sharedPtr<SharedNode> next;
+    explicit SharedNode(long v) : value(v) {}
+};
+
+struct IntrusiveNode : refCounted<IntrusiveNode> {
+    long value;
+    intrusivePtr<IntrusiveNode> next;
+    explicit IntrusiveNode(long v) : value(v) {}
+};
+
+// pointer chasing benchmark - walks the list by copying the 'next' pointer on every hop, the way a pipeline stage hands objects on,
+// so every hop pays for an increment and a decrement. reported as nanoseconds per node
+template<typename Node, typename Ptr>
+void chaseList(const char* name, long numNodes) {
+    Ptr head;
+    for(long i=numNodes-1; i>=0; i--) {
+        Ptr node(new Node(i));
+        node->next = std::move(head);
+        head = std::move(node);
+    }
+
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(Ptr cur = head; cur; cur = cur->next) {
+        sum += cur->value;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    // the list is torn down one node at a time - letting the destructors recurse through 10M nodes would overflow the stack
+    while(head) {
+        Ptr next = std::move(head->next);
+        head = std::move(next);
+    }
+
+    std::cout << name << elapsed.count() / numNodes << " ns/node (sum " << sum << ")" << std::endl;
+}
+
+// a fixed-size object pool with an intrusive free list - released objects are pushed on the list and reused by the next acquire,
+// so after warm up the pool never touches the allocator. each thread gets its own pool, which keeps it lock-free
+template<typename T>
+class ObjectPool {
+    private:
+        union Slot {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        Slot* freeList = nullptr;
+
+    public:
+        static ObjectPool& instance() {
+            thread_local ObjectPool pool;
+            return pool;
+        }
+
+        template<typename... Args>
+        T* acquire(Args&&... args) {
+            Slot* slot = freeList ? std::exchange(freeList, freeList->next) : new Slot;
+            return ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+        }
+
+        void giveBack(T* ptr) {
+            ptr->~T();
+            Slot* slot = reinterpret_cast<Slot*>(ptr);
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+        ~ObjectPool() {
+            while(freeList) delete std::exchange(freeList, freeList->next);
+        }
+};
+
+// stateless deleter which returns the object to the pool of the current thread - being empty, it costs uniquePtr no space
+template<typename T>
+struct PoolDeleter {
+    void operator()(T* ptr) const { ObjectPool<T>::instance().giveBack(ptr); }
+};
+
+// stateful deleter which remembers its pool - stored as a member, so it does cost space
+template<typename T>
+struct BoundPoolDeleter {
+    ObjectPool<T>* pool;
+    void operator()(T* ptr) const { pool->giveBack(ptr); }
+};
+
+// size test - a stateless deleter must not make uniquePtr bigger than a raw pointer
+static_assert(sizeof(uniquePtr<Payload, PoolDeleter<Payload>>) == sizeof(Payload*), "stateless deleter must take no space");
+static_assert(sizeof(uniquePtr<Payload[], PoolDeleter<Payload>>) == sizeof(Payload*), "stateless deleter must take no space");
+static_assert(sizeof(uniquePtr<Payload, BoundPoolDeleter<Payload>>) == 2 * sizeof(Payload*), "stateful deleter is stored as a member");
+
+// pool return benchmark - acquires a batch of objects, owns each of them through a uniquePtr and lets the uniquePtr give them back
+template<typename Make>
+void acquireAndRelease(const char* name, long count, Make make) {
+    constexpr int batch = 64;
+    allocationCounts before = allocationSnapshot();
+    auto start = std::chrono::steady_clock::now();
+    for(long i=0; i<count; i+=batch) {
+        decltype(make(0)) owners[batch];
+        for(int j=0; j<batch; j++) owners[j] = make(i + j);
+        asm volatile("" : : "r"(owners) : "memory");
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double allocationsPerObject = double((allocationSnapshot() - before).allocations) / count;
+    std::cout << name << allocationsPerObject << " allocations/object, " << elapsed.count() / count << " ns/object" << std::endl;
+}
+
+// move benchmark - ping-pongs ownership between two slots. with tracing compiled out a uniquePtr move should cost the same as moving a
+// raw pointer; the barrier keeps the compiler from collapsing the loop since both slots have to be in memory on every iteration
+template<typename Ptr, typename Move>
+double nsPerMove(Ptr first, long count, Move move) {
+    Ptr second{};
+    auto start = std::chrono::steady_clock::now();
+    for(long i=0; i<count; i++) {
+        move(second, first);
+        asm volatile("" : : "r"(&first), "r"(&second) : "memory");
+        move(first, second);
+        asm volatile("" : : "r"(&first), "r"(&second) : "memory");
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (2 * count);
+}
+
+// promotion benchmark - every thread is a reader which repeatedly promotes the same weak pointer to a strong one and drops it again,
+// which is what a cache lookup does. reported as lock() calls per second, summed over all the threads
+template<typename Weak>
+double locksPerSecond(const Weak& source, int numThreads, long locksPerThread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(int t=0; t<numThreads; t++) {
+        threads.emplace_back([&source, locksPerThread] {
+            for(long i=0; i<locksPerThread; i++) {
+                auto strong = source.lock();
+                asm volatile("" : : "r"(strong.get()) : "memory");
+            }
+        });
+    }
+    for(auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return numThreads * locksPerThread / elapsed.count();
+}
+
+// creation benchmark - builds and destroys 'count' pointers using the given factory, and reports the allocations and the average
+// nanoseconds per create + destroy cycle
+template<typename Factory>
+void createAndDestroy(const char* name, long count, Factory make) {
+    allocationCounts before = allocationSnapshot();
+    auto start = std::chrono::steady_clock::now();
+    for(long i=0; i<count; i++) {
+        auto ptr = make(i);
+        asm volatile("" : : "r"(ptr.get()) : "memory");
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double allocationsPerPointer = double((allocationSnapshot() - before).allocations) / count;
+    std::cout << name << allocationsPerPointer << " allocations/pointer, " << elapsed.count() / count << " ns/pointer" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int numThreads = argc > 1 ? std::atoi(argv[1]) : 4;
+    long copiesPerThread = argc > 2 ? std::atol(argv[2]) : 1000000;
+    long numNodes = argc > 3 ? std::atol(argv[3]) : 10000000;
+
+    std::cout << "threads: " << numThreads << ", copies per thread: " << copiesPerThread << std::endl;
+
+    sharedPtr<int> mine(new int(42));
+    double mineRate = copiesPerSecond(mine, numThreads, copiesPerThread);
+
+    std::shared_ptr<int> standard = std::make_shared<int>(42);
+    double standardRate = copiesPerSecond(standard, numThreads, copiesPerThread);
+
+    std::cout << "sharedPtr       : " << mineRate << " copies/sec (count after run: " << mine.getCount() << ")" << std::endl;
+    std::cout << "std::shared_ptr : " << standardRate << " copies/sec (count after run: " << standard.use_count() << ")" << std::endl;
+
+    // weak to strong promotion under many readers, while one strong owner keeps the resource alive
+    weakPtr<int> mineWeak(mine);
+    double mineLockRate = locksPerSecond(mineWeak, numThreads, copiesPerThread);
+
+    std::weak_ptr<int> standardWeak(standard);
+    double standardLockRate = locksPerSecond(standardWeak, numThreads, copiesPerThread);
+
+    std::cout << "weakPtr::lock       : " << mineLockRate << " locks/sec" << std::endl;
+    std::cout << "std::weak_ptr::lock : " << standardLockRate << " locks/sec" << std::endl;
+
+    // two allocations (new Payload + control block) against a single one from makeShared, with std::make_shared as the reference
+    long count = copiesPerThread;
+    createAndDestroy("sharedPtr(new T) : ", count, [](long i) { return sharedPtr<Payload>(new Payload(i)); });
+    createAndDestroy("makeShared<T>    : ", count, [](long i) { return makeShared<Payload>(i); });
+    createAndDestroy("std::make_shared : ", count, [](long i) { return std::make_shared<Payload>(i); });
+
+    // objects given back to a pool by the deleter, against new/delete
+    acquireAndRelease("uniquePtr<T> new/delete  : ", count, [](long i) { return uniquePtr<Payload>(new Payload(i)); });
+    acquireAndRelease("uniquePtr<T, PoolDeleter> : ", count, [](long i) {
+        return uniquePtr<Payload, PoolDeleter<Payload>>(ObjectPool<Payload>::instance().acquire(i));
+    });
+
+    // moves with tracing compiled out, against raw pointer moves
+    Payload rawPayload(1);
+    Payload* raw = &rawPayload;
+    double rawMove = nsPerMove(raw, count * 10, [](Payload*& to, Payload*& from) { to = std::exchange(from, nullptr); });
+    double uniqueMove = nsPerMove(uniquePtr<Payload>(new Payload(1)), count * 10, [](uniquePtr<Payload>& to, uniquePtr<Payload>& from) {
+        to = std::move(from);
+    });
+    std::cout << "raw pointer move : " << rawMove << " ns/move" << std::endl;
+    std::cout << "uniquePtr move   : " << uniqueMove << " ns/move (tracing " << (SMARTPOINTERS_TRACING ? "on" : "off") << ")" << std::endl;
+
+    // pointer chasing over a linked list, count in a control block against count inside the node
+    chaseList<SharedNode, sharedPtr<SharedNode>>("sharedPtr list    : ", numNodes);
+    chaseList<IntrusiveNode, intrusivePtr<IntrusiveNode>>("intrusivePtr list : ", numNodes);
+
+    return 0;
+}
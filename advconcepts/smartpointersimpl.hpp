@@ -0,0 +1,639 @@
+// header file for the uniquePtr and sharedPtr implementations (shared by the demo and the benchmarks)
+#ifndef SMARTPOINTERSIMPL_HPP
+#define SMARTPOINTERSIMPL_HPP
+
+#include <ostream>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+// lifecycle tracing - every constructor, assignment and destructor of the smart pointers reports an event to 'tracePolicy'
+// tracing is a compile-time switch: it is off by default, and then the policy is an empty inline function which the compiler removes
+// entirely, so the pointers cost the same as raw pointers. compile with -DSMARTPOINTERS_TRACING=1 (or define it before including
+// this header) to record the events instead
+#ifndef SMARTPOINTERS_TRACING
+#define SMARTPOINTERS_TRACING 0
+#endif
+
+enum class traceEvent : unsigned char {
+    construct, copyConstruct, copyAssign, moveConstruct, moveAssign, destroy
+};
+
+inline const char* traceEventName(traceEvent event) {
+    switch(event) {
+        case traceEvent::construct:     return "constructor";
+        case traceEvent::copyConstruct: return "copy constructor";
+        case traceEvent::copyAssign:    return "copy assignment";
+        case traceEvent::moveConstruct: return "move constructor";
+        case traceEvent::moveAssign:    return "move assignment";
+        case traceEvent::destroy:       return "destructor";
+    }
+    return "unknown";
+}
+
+// tracing disabled - nothing is recorded
+struct noTracing {
+    static void record(traceEvent, const void*) noexcept {}
+};
+
+// tracing enabled - each thread appends its events to its own ring buffer, so recording never takes a lock or contends with other
+// threads (the only lock is taken once per thread, when its buffer is registered). the buffers outlive their threads so that they
+// can be dumped at the end - dump() should be called once the traced threads are done, as it does not synchronise with writers
+// that wrap around the ring
+struct bufferTracing {
+    struct entry {
+        traceEvent event;
+        const void* ptr;
+    };
+
+    static constexpr std::size_t capacity = 4096;
+
+    struct threadBuffer {
+        entry entries[capacity];
+        std::atomic<std::size_t> written{0};
+    };
+
+    static std::mutex& registryLock() {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::vector<std::unique_ptr<threadBuffer>>& registry() {
+        static std::vector<std::unique_ptr<threadBuffer>> buffers;
+        return buffers;
+    }
+
+    static threadBuffer& localBuffer() {
+        thread_local threadBuffer* buffer = [] {
+            std::lock_guard<std::mutex> guard(registryLock());
+            registry().push_back(std::make_unique<threadBuffer>());
+            return registry().back().get();
+        }();
+        return *buffer;
+    }
+
+    // only the owning thread writes to its buffer, so a plain store followed by a release of the new size is enough
+    static void record(traceEvent event, const void* ptr) noexcept {
+        threadBuffer& buffer = localBuffer();
+        std::size_t n = buffer.written.load(std::memory_order_relaxed);
+        buffer.entries[n % capacity] = entry{event, ptr};
+        buffer.written.store(n + 1, std::memory_order_release);
+    }
+
+    // prints the most recent events of every thread, oldest first
+    static void dump(std::ostream& out) {
+        std::lock_guard<std::mutex> guard(registryLock());
+        for(std::size_t t=0; t<registry().size(); t++) {
+            const threadBuffer& buffer = *registry()[t];
+            std::size_t n = buffer.written.load(std::memory_order_acquire);
+            std::size_t first = n > capacity ? n - capacity : 0;
+            out << "thread " << t << " (" << n << " events)\n";
+            for(std::size_t i=first; i<n; i++) {
+                const entry& e = buffer.entries[i % capacity];
+                out << "  " << e.ptr << " " << traceEventName(e.event) << "\n";
+            }
+        }
+    }
+};
+
+using tracePolicy = std::conditional_t<SMARTPOINTERS_TRACING != 0, bufferTracing, noTracing>;
+
+// default deleters used by uniquePtr - plain 'delete' for single objects and 'delete[]' for arrays
+// they have no data members, so storing them costs no space (see compressedPtr below)
+template<typename T>
+struct defaultDelete {
+    void operator()(T* ptr) const { delete ptr; }
+};
+
+template<typename T>
+struct defaultDelete<T[]> {
+    void operator()(T* ptr) const { delete[] ptr; }
+};
+
+// stores the resource pointer together with the deleter. an empty (stateless) deleter is stored as a base class instead of a member,
+// so the empty base optimisation makes it take no space and sizeof(uniquePtr<T, D>) == sizeof(T*). stateful deleters (e.g. one holding
+// a pointer to its pool) and final classes cannot be used as a base, so they are stored as a regular member
+template<typename T, typename Deleter, bool = std::is_empty<Deleter>::value && !std::is_final<Deleter>::value>
+class compressedPtr : private Deleter {
+    public:
+        T* res;
+
+        compressedPtr(T* ptr, Deleter deleter) : Deleter(std::move(deleter)), res(ptr) {}
+
+        Deleter& getDeleter() { return *this; }
+        const Deleter& getDeleter() const { return *this; }
+};
+
+template<typename T, typename Deleter>
+class compressedPtr<T, Deleter, false> {
+    private:
+        Deleter deleter;
+
+    public:
+        T* res;
+
+        compressedPtr(T* ptr, Deleter d) : deleter(std::move(d)), res(ptr) {}
+
+        Deleter& getDeleter() { return deleter; }
+        const Deleter& getDeleter() const { return deleter; }
+};
+
+// generic typed RAII style class for unique pointer
+// the deleter decides how the resource is given back - by default it is deleted, but objects coming from a pool or an arena can be
+// returned there instead by passing a different deleter type
+template<typename T, typename Deleter = defaultDelete<T>>
+class uniquePtr {
+    private:
+        // a pointer which points to the resource, along with the deleter
+        compressedPtr<T, Deleter> ptr_;
+
+    public:
+        // regular parameterised constructor with initialiser list
+        uniquePtr(T* ptr = nullptr, Deleter deleter = Deleter()) : ptr_(ptr, std::move(deleter)) {
+            tracePolicy::record(traceEvent::construct, this);
+        }   
+
+        // since this pointer can have only one pointing to a particular resource, the copy constructor and copy assignment operators
+        // are 'deleted' - which ensures that these constructors remain disabled 
+        uniquePtr(const uniquePtr& ptr) = delete;
+        uniquePtr& operator=(const uniquePtr& ptr) = delete;
+
+        // move constructor - since the pointer being assigned does not have any value, no need to delete it, just assign it the resource
+        // and unlink 'ptr' from that same resource, to ensure only one pointer points to the resource at a time
+        // the deleter travels along with the resource, since it is the one which knows how to free it
+        uniquePtr(uniquePtr&& ptr) noexcept : ptr_(std::exchange(ptr.ptr_.res, nullptr), std::move(ptr.ptr_.getDeleter())) {
+            tracePolicy::record(traceEvent::moveConstruct, this);
+        }
+
+        // move assignment operator - now, we need to make sure we do not end up doing ptr = ptr and causing unexpected behaviour, so for that
+        // we provide a condition which checks whether the pointers are the same or not, and perform the move assignment only when not same
+        // in move assigning, the pointer being assigned is unlinked from its previous resource first, and then this new resource is assigned
+        uniquePtr& operator=(uniquePtr&& ptr) noexcept {
+            tracePolicy::record(traceEvent::moveAssign, this);
+            if(this != &ptr) {
+                reset(ptr.release());
+                ptr_.getDeleter() = std::move(ptr.ptr_.getDeleter());
+            }
+            return *this;
+        }
+
+        T* operator->() const {
+            return ptr_.res;
+        }
+
+        T& operator*() const {
+            return *ptr_.res;
+        }
+
+        T* get() const {
+            return ptr_.res;
+        }
+
+        Deleter& getDeleter() {
+            return ptr_.getDeleter();
+        }
+
+        explicit operator bool() const {
+            return ptr_.res != nullptr;
+        }
+
+        // gives up ownership without freeing the resource - the caller becomes responsible for it
+        T* release() {
+            return std::exchange(ptr_.res, nullptr);
+        }
+
+        // reset functionality just involves unlinking the pointer from its current resource, and assigning it a new resource
+        void reset(T* newRes = nullptr) {
+            T* old = std::exchange(ptr_.res, newRes);
+            if(old) ptr_.getDeleter()(old);
+        }
+
+        // destructor makes sure that all the dynamically allocated resources are de-allocated when the object goes out of scope
+        ~uniquePtr() {
+            reset();
+            tracePolicy::record(traceEvent::destroy, this);
+        }
+};
+
+// array form of uniquePtr - same ownership rules, but frees the resource with delete[] by default and offers indexing instead of -> and *
+template<typename T, typename Deleter>
+class uniquePtr<T[], Deleter> {
+    private:
+        compressedPtr<T, Deleter> ptr_;
+
+    public:
+        uniquePtr(T* ptr = nullptr, Deleter deleter = Deleter()) : ptr_(ptr, std::move(deleter)) {
+            tracePolicy::record(traceEvent::construct, this);
+        }
+
+        uniquePtr(const uniquePtr& ptr) = delete;
+        uniquePtr& operator=(const uniquePtr& ptr) = delete;
+
+        uniquePtr(uniquePtr&& ptr) noexcept : ptr_(std::exchange(ptr.ptr_.res, nullptr), std::move(ptr.ptr_.getDeleter())) {
+            tracePolicy::record(traceEvent::moveConstruct, this);
+        }
+
+        uniquePtr& operator=(uniquePtr&& ptr) noexcept {
+            tracePolicy::record(traceEvent::moveAssign, this);
+            if(this != &ptr) {
+                reset(ptr.release());
+                ptr_.getDeleter() = std::move(ptr.ptr_.getDeleter());
+            }
+            return *this;
+        }
+
+        T& operator[](std::size_t idx) const {
+            return ptr_.res[idx];
+        }
+
+        T* get() const {
+            return ptr_.res;
+        }
+
+        Deleter& getDeleter() {
+            return ptr_.getDeleter();
+        }
+
+        explicit operator bool() const {
+            return ptr_.res != nullptr;
+        }
+
+        T* release() {
+            return std::exchange(ptr_.res, nullptr);
+        }
+
+        void reset(T* newRes = nullptr) {
+            T* old = std::exchange(ptr_.res, newRes);
+            if(old) ptr_.getDeleter()(old);
+        }
+
+        ~uniquePtr() {
+            reset();
+            tracePolicy::record(traceEvent::destroy, this);
+        }
+};
+
+// the default deleters are empty, so a uniquePtr is exactly as big as the raw pointer it wraps
+static_assert(sizeof(uniquePtr<int>) == sizeof(int*), "uniquePtr with a stateless deleter must be pointer-sized");
+static_assert(sizeof(uniquePtr<int[]>) == sizeof(int*), "uniquePtr with a stateless deleter must be pointer-sized");
+
+// control block shared by all the sharedPtr and weakPtr instances pointing to the same resource
+// the counts are atomic so that copies of the same pointer can be created and destroyed from different threads without a data race
+// how the resource is destroyed depends on how it was allocated, so that part is left to the derived control blocks
+
+// two counts are kept: 'strong' counts the sharedPtr owners and decides when the resource is destroyed, while 'weak' counts the weakPtr
+// observers (plus one for all the strong owners together) and decides when the control block itself is freed
+struct controlBlock {
+    std::atomic<long> strong;
+    std::atomic<long> weak;
+
+    controlBlock() : strong(1), weak(1) {}
+    virtual ~controlBlock() = default;
+
+    // called exactly once, by the owner which drops the strong count to zero
+    virtual void destroyResource() noexcept = 0;
+
+    // a new owner can only be created from an existing owner, which already keeps the resource alive, so the increment does not
+    // need to order any other memory access and can be relaxed
+    void addStrong() noexcept {
+        strong.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // promotion from a weak reference - the resource may be destroyed at any moment, so the count is only incremented if it is not
+    // already zero. this is a compare-exchange loop instead of a lock, so readers never block each other
+    bool tryAddStrong() noexcept {
+        long current = strong.load(std::memory_order_relaxed);
+        while(current != 0) {
+            if(strong.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    // the decrement is a release so that every write made through this owner happens-before the destruction, and the thread which
+    // drops the last reference performs an acquire fence so that it sees all those writes before destroying the resource
+    void releaseStrong() noexcept {
+        if(strong.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            destroyResource();
+            releaseWeak();
+        }
+    }
+
+    void addWeak() noexcept {
+        weak.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // same ordering as releaseStrong, but for the control block itself
+    void releaseWeak() noexcept {
+        if(weak.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete this;
+        }
+    }
+};
+
+// control block for a resource allocated separately by the caller (sharedPtr<T>(new T)) - two allocations per resource
+template<typename T>
+struct pointerControlBlock : controlBlock {
+    T* res;
+
+    explicit pointerControlBlock(T* ptr) : res(ptr) {}
+    void destroyResource() noexcept override { delete res; }
+};
+
+// control block with the resource living inside it (used by makeShared) - a single allocation holds both the count and the object,
+// so they usually share a cache line as well
+template<typename T>
+struct inplaceControlBlock : controlBlock {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    template<typename... Args>
+    explicit inplaceControlBlock(Args&&... args) {
+        ::new (static_cast<void*>(storage)) T(std::forward<Args>(args)...);
+    }
+
+    T* get() noexcept { return reinterpret_cast<T*>(storage); }
+    void destroyResource() noexcept override { get()->~T(); }
+};
+
+template<typename T>
+class sharedPtr;
+
+template<typename T>
+class weakPtr;
+
+template<typename T, typename... Args>
+sharedPtr<T> makeShared(Args&&... args);
+
+// generic typed RAII style class for shared pointer
+template<typename T>
+class sharedPtr {
+    private: 
+        // along with a pointer to resource, this smart pointer also keeps track of a control block
+        // which acutally helps track how many pointers are pointing to this particular resource
+        T* res;
+        controlBlock* counter;
+
+        // private function to increment counter
+        void incrementCounter() {
+            if(counter) counter->addStrong();
+        }
+
+        // private function to decrement counter - note that if the count becomes zero, the resource is unlinked 
+        // and the smart pointer is reset (the control block takes care of the memory ordering)
+        void decrementCounter() {
+            if(counter) {
+                counter->releaseStrong();
+                res = nullptr;
+                counter = nullptr;
+            }
+        }
+
+        // used by makeShared and weakPtr::lock, which have already accounted for this owner in the control block
+        sharedPtr(T* ptr, controlBlock* block) : res(ptr), counter(block) {
+            tracePolicy::record(traceEvent::construct, this);
+        }
+
+        // we own 'ptr' from the moment it is passed in (like std::shared_ptr), so if allocating its control block throws, the object
+        // is deleted before the exception leaves - otherwise sharedPtr<T>(new T) would leak it
+        static controlBlock* controlBlockFor(T* ptr) {
+            if(!ptr) return nullptr;
+            try {
+                return new pointerControlBlock<T>(ptr);
+            } catch(...) {
+                delete ptr;
+                throw;
+            }
+        }
+
+        template<typename U, typename... Args>
+        friend sharedPtr<U> makeShared(Args&&... args);
+
+        friend class weakPtr<T>;
+
+    public:
+        // constructor - an empty pointer does not need a control block
+        sharedPtr(T* ptr = nullptr) : res(ptr), counter(controlBlockFor(ptr)) {
+            tracePolicy::record(traceEvent::construct, this);
+        }
+
+        // copy constructor - increments the counter after assigning the resource to the shared pointer
+        sharedPtr(const sharedPtr<T>& ptr) {
+            tracePolicy::record(traceEvent::copyConstruct, this);
+            res = ptr.res;
+            counter = ptr.counter;
+            incrementCounter();
+        }
+        
+        // copy assignment operator - now, both 'this' and 'ptr' are pointing to different resources, so we first decrement the counter
+        // assign the resources and counter of 'ptr' to the current shared pointer, and then increment pointer
+        // note that, both ptr and 'this' should not be equal, to avoid undefined behaviour
+        sharedPtr& operator=(const sharedPtr<T>& ptr) {
+            tracePolicy::record(traceEvent::copyAssign, this);
+            if(this != &ptr) {
+                decrementCounter();
+                res = ptr.res;
+                counter = ptr.counter;
+                incrementCounter();
+            }
+            return *this;
+        }   
+
+        // move constructor - we just need to move the ownership from 'ptr' to the current pointer
+        // count does not change, but 'ptr' must let go of the resource, otherwise its destructor would decrement the count a second time
+        sharedPtr(sharedPtr<T>&& ptr) noexcept {
+            tracePolicy::record(traceEvent::moveConstruct, this);
+            res = std::exchange(ptr.res, nullptr);
+            counter = std::exchange(ptr.counter, nullptr);
+            // no need to increment count
+        }
+
+        // move assignment operator - now both 'ptr' and 'this' point to different resources, so we first decrement the count of
+        // current pointer, assign it to point to the new resource, and make 'ptr' point to nothing since ownership has now been transferred
+        // again, we cannot have both 'this' and 'ptr' point to the same resource, so we check that before doing any operation
+        sharedPtr& operator=(sharedPtr<T>&& ptr) noexcept {
+            tracePolicy::record(traceEvent::moveAssign, this);
+            if(this != &ptr) {
+                decrementCounter();
+                res = std::exchange(ptr.res, nullptr);
+                counter = std::exchange(ptr.counter, nullptr);
+            }
+            return *this;
+        }
+
+        // reset - decrement the counter, then assign new resource to the current pointer
+        // now since the pointer points to a new resource, we need a new counter as well, to keep track
+        // of the number of shared pointers pointing to that resource
+        // the new counter is allocated before the old resource is released, so if that throws this pointer is left as it was
+        void reset(T* newRes = nullptr) {
+            controlBlock* block = controlBlockFor(newRes);
+            decrementCounter();
+            res = newRes;
+            counter = block;
+        }
+
+        // the count can change concurrently, so this is only a snapshot
+        long getCount() const { return counter ? counter->strong.load(std::memory_order_relaxed) : 0; }
+
+        T* operator->() const { return res; }
+        T& operator*() const { return *res; }
+        T* get() const { return res; }
+        explicit operator bool() const { return res != nullptr; }
+
+        // we have taken care of the resource destruction logic in the decrementCounter function
+        ~sharedPtr() {
+            tracePolicy::record(traceEvent::destroy, this);
+            decrementCounter();
+        }
+
+};
+
+// generic typed class for weak pointer - observes a resource owned by sharedPtr without keeping it alive
+// it only holds on to the control block (through the weak count), so the resource is destroyed as soon as the last sharedPtr goes away
+// and the weakPtr has to be promoted with lock() before the resource can be used
+template<typename T>
+class weakPtr {
+    private:
+        T* res;
+        controlBlock* counter;
+
+    public:
+        weakPtr() : res(nullptr), counter(nullptr) {}
+
+        weakPtr(const sharedPtr<T>& ptr) : res(ptr.res), counter(ptr.counter) {
+            if(counter) counter->addWeak();
+        }
+
+        weakPtr(const weakPtr<T>& ptr) : res(ptr.res), counter(ptr.counter) {
+            if(counter) counter->addWeak();
+        }
+
+        weakPtr(weakPtr<T>&& ptr) noexcept : res(std::exchange(ptr.res, nullptr)), counter(std::exchange(ptr.counter, nullptr)) {}
+
+        // copy-swap style assignment - the by-value parameter takes care of both copy and move assignment
+        weakPtr& operator=(weakPtr<T> ptr) noexcept {
+            std::swap(res, ptr.res);
+            std::swap(counter, ptr.counter);
+            return *this;
+        }
+
+        // promotion to a sharedPtr - returns an empty sharedPtr if the resource has already been destroyed
+        sharedPtr<T> lock() const {
+            if(counter && counter->tryAddStrong()) return sharedPtr<T>(res, counter);
+            return sharedPtr<T>();
+        }
+
+        bool expired() const { return getCount() == 0; }
+
+        // the count can change concurrently, so this is only a snapshot
+        long getCount() const { return counter ? counter->strong.load(std::memory_order_relaxed) : 0; }
+
+        void reset() {
+            if(counter) counter->releaseWeak();
+            res = nullptr;
+            counter = nullptr;
+        }
+
+        ~weakPtr() {
+            reset();
+        }
+};
+
+// CRTP base class for intrusive reference counting - the count lives inside the object itself, so copying an intrusivePtr touches
+// one cache line (the object) instead of two (the object and a separately allocated control block)
+// since the base knows the derived type, the last release can delete the full object without needing a virtual destructor
+template<typename Derived>
+class refCounted {
+    private:
+        mutable std::atomic<long> refs;
+
+    protected:
+        refCounted() : refs(0) {}
+        // copying an object must not copy its owners, so the copy starts with a count of zero and assignment leaves the count alone
+        refCounted(const refCounted&) : refs(0) {}
+        refCounted& operator=(const refCounted&) { return *this; }
+        ~refCounted() = default;
+
+    public:
+        // same memory ordering as controlBlock - relaxed increments, release decrements and an acquire fence before the delete
+        void addRef() const noexcept {
+            refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release() const noexcept {
+            if(refs.fetch_sub(1, std::memory_order_release) == 1) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                delete static_cast<const Derived*>(this);
+            }
+        }
+
+        long getCount() const { return refs.load(std::memory_order_relaxed); }
+};
+
+// generic typed RAII style class for intrusive pointer - same interface as sharedPtr, but T must derive from refCounted<T>
+template<typename T>
+class intrusivePtr {
+    private:
+        T* res;
+
+    public:
+        intrusivePtr(T* ptr = nullptr) : res(ptr) {
+            if(res) res->addRef();
+        }
+
+        intrusivePtr(const intrusivePtr<T>& ptr) : res(ptr.res) {
+            if(res) res->addRef();
+        }
+
+        intrusivePtr(intrusivePtr<T>&& ptr) noexcept : res(std::exchange(ptr.res, nullptr)) {}
+
+        // the new resource is acquired before the old one is released, so self-assignment (or assigning a pointer which is only kept
+        // alive by the current one) is safe without a separate check
+        intrusivePtr& operator=(const intrusivePtr<T>& ptr) {
+            if(ptr.res) ptr.res->addRef();
+            T* old = std::exchange(res, ptr.res);
+            if(old) old->release();
+            return *this;
+        }
+
+        intrusivePtr& operator=(intrusivePtr<T>&& ptr) noexcept {
+            if(this != &ptr) {
+                T* old = std::exchange(res, std::exchange(ptr.res, nullptr));
+                if(old) old->release();
+            }
+            return *this;
+        }
+
+        void reset(T* newRes = nullptr) {
+            intrusivePtr<T>(newRes).swap(*this);
+        }
+
+        void swap(intrusivePtr<T>& ptr) noexcept {
+            std::swap(res, ptr.res);
+        }
+
+        long getCount() const { return res ? res->getCount() : 0; }
+
+        T* operator->() const { return res; }
+        T& operator*() const { return *res; }
+        T* get() const { return res; }
+        explicit operator bool() const { return res != nullptr; }
+
+        ~intrusivePtr() {
+            if(res) res->release();
+        }
+};
+
+// factory function which creates the resource and its control block with a single allocation, instead of one for 'new T' and one
+// for the control block - this halves the allocator traffic and keeps the count next to the object
+template<typename T, typename... Args>
+sharedPtr<T> makeShared(Args&&... args) {
+    auto* block = new inplaceControlBlock<T>(std::forward<Args>(args)...);
+    return sharedPtr<T>(block->get(), block);
+}
+
+#endif
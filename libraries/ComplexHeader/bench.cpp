@@ -0,0 +1,91 @@
+// MyApp-style loops before and after making the complex arithmetic header-only
+#include "complex.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+// build with the CMake target ComplexHeaderBench, or by hand:
+//     g++ -std=c++17 -O2 -march=native bench.cpp -o bench
+// run with: ./bench [samples] [repeats]
+
+// 'before' - the class as it was in ComplexStatic/ComplexShared: operators on non-const references, defined out of line. noinline
+// stands in for the library boundary (library.cpp was compiled separately, so the application only ever saw a call)
+class LegacyComplex {
+public:
+    double re, im;
+    LegacyComplex() : LegacyComplex(0, 0) {}
+    LegacyComplex(double r, double i) : re{r}, im{i} {}
+    LegacyComplex operator+(LegacyComplex& other);
+    LegacyComplex operator*(LegacyComplex& other);
+};
+
+__attribute__((noinline)) LegacyComplex LegacyComplex::operator+(LegacyComplex &other) {
+    LegacyComplex sum;
+    sum.re = this->re + other.re;
+    sum.im = this->im + other.im;
+    return sum;
+}
+
+__attribute__((noinline)) LegacyComplex LegacyComplex::operator*(LegacyComplex &other) {
+    LegacyComplex prod;
+    double a = this->re, b = this->im, c = other.re, d = other.im;
+    prod.re = a*c - b*d;
+    prod.im = a*d + b*c;
+    return prod;
+}
+
+// the loops of MyApp: an elementwise product of two signals, and a dot product accumulated into one value
+template<typename C>
+void multiplyAll(std::vector<C>& a, std::vector<C>& b, std::vector<C>& out) {
+    for(std::size_t i = 0; i < a.size(); i++) out[i] = a[i] * b[i];
+}
+
+template<typename C>
+C dot(std::vector<C>& a, std::vector<C>& b) {
+    C sum;
+    for(std::size_t i = 0; i < a.size(); i++) {
+        C prod = a[i] * b[i];
+        sum = sum + prod;
+    }
+    return sum;
+}
+
+template<typename C>
+void run(const char* name, std::size_t n, int repeats) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<C> a(n), b(n), out(n);
+    for(std::size_t i = 0; i < n; i++) {
+        a[i] = C(decltype(C::re)(dist(rng)), decltype(C::re)(dist(rng)));
+        b[i] = C(decltype(C::re)(dist(rng)), decltype(C::re)(dist(rng)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        multiplyAll(a, b, out);
+        asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    std::chrono::duration<double, std::nano> multiplyTime = std::chrono::steady_clock::now() - start;
+
+    double check = 0;
+    start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) check += double(dot(a, b).re);
+    std::chrono::duration<double, std::nano> dotTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << multiplyTime.count() / (double(n) * repeats) << " ns/sample elementwise, "
+              << dotTime.count() / (double(n) * repeats) << " ns/sample dot product (" << check << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 16;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    run<LegacyComplex>("before, out-of-line double : ", n, repeats);
+    run<Complex<double>>("after, Complex<double>     : ", n, repeats);
+    run<Complex<float>>("after, Complex<float>      : ", n, repeats);
+    run<Complex<long double>>("after, Complex<long double>: ", n, repeats);
+
+    return 0;
+}
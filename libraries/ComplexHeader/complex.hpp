@@ -0,0 +1,85 @@
+#ifndef COMPLEXHEADER_COMPLEX_HPP
+#define COMPLEXHEADER_COMPLEX_HPP
+
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// header-only complex number, shared by ComplexStatic and ComplexShared (both are aliases of Complex<double> now)
+// the operators used to live in library.cpp behind the static/shared library boundary and took non-const references, so every
+// a * b in a loop of the application was an opaque call - nothing could be inlined and the loop could not be vectorised. defined
+// here as constexpr and noexcept on const references, they compile down to the few multiplies and adds they really are
+template<typename T>
+class Complex {
+    static_assert(std::is_floating_point<T>::value, "Complex<T> needs float, double or long double");
+
+public:
+    T re, im;
+
+    constexpr Complex() noexcept : re{0}, im{0} {}
+    constexpr Complex(T r, T i) noexcept : re{r}, im{i} {}
+
+    void print() const {
+        std::cout << "Number is: " << re << (im >= 0 ? " + " : " - ") << std::abs(im) << "i" << std::endl;
+    }
+
+    constexpr Complex operator+(const Complex& other) const noexcept {
+        return Complex(re + other.re, im + other.im);
+    }
+
+    constexpr Complex operator-(const Complex& other) const noexcept {
+        return Complex(re - other.re, im - other.im);
+    }
+
+    constexpr Complex operator*(const Complex& other) const noexcept {
+        return Complex(re * other.re - im * other.im, re * other.im + im * other.re);
+    }
+
+    // smith's algorithm: divides through by the larger part of the divisor, so that nothing overflows or underflows unless the
+    // quotient itself does (the textbook (ac + bd) / (c*c + d*d) overflows once |c| or |d| passes ~1e154 in double, and loses
+    // everything to underflow below ~1e-154). special values follow C99 Annex G, like the built-in complex types - see annexG
+    constexpr Complex operator/(const Complex& other) const noexcept {
+        // the larger part of the divisor is p and the other q, and the parts of the dividend are swapped to match - written with
+        // selects rather than two branches, the compiler can use conditional moves and vectorise loops of divisions
+        const bool swap = (other.re < 0 ? -other.re : other.re) < (other.im < 0 ? -other.im : other.im);
+        const T p = swap ? other.im : other.re, q = swap ? other.re : other.im;
+        const T x = swap ? im : re, y = swap ? re : im;
+        const T r = q / p, den = p + q * r, xr = x * r;
+        const T e = (x + y * r) / den, f = (swap ? xr - y : y - xr) / den;
+        if(e != e && f != f) return annexG(re, im, other.re, other.im, e, f);
+        return Complex(e, f);
+    }
+
+    constexpr bool operator==(const Complex& other) const noexcept { return re == other.re && im == other.im; }
+    constexpr bool operator!=(const Complex& other) const noexcept { return !(*this == other); }
+
+    // the recovery of C99 Annex G (G.5.1), for the quotients which came out as NaN + NaN i although the operands say otherwise:
+    // - a non-zero number divided by zero is infinite (0/0 stays NaN)
+    // - an infinite number divided by a finite one is infinite
+    // - a finite number divided by an infinite one is zero
+    // it used to return 0 for any zero divisor, which hid the error from the caller
+    static Complex annexG(T a, T b, T c, T d, T e, T f) noexcept {
+        const T inf = std::numeric_limits<T>::infinity();
+        if(c == 0 && d == 0 && (!std::isnan(a) || !std::isnan(b))) {
+            return Complex(std::copysign(inf, c) * a, std::copysign(inf, c) * b);
+        }
+        if((std::isinf(a) || std::isinf(b)) && std::isfinite(c) && std::isfinite(d)) {
+            a = std::copysign(std::isinf(a) ? T(1) : T(0), a);
+            b = std::copysign(std::isinf(b) ? T(1) : T(0), b);
+            return Complex(inf * (a * c + b * d), inf * (b * c - a * d));
+        }
+        if((std::isinf(c) || std::isinf(d)) && std::isfinite(a) && std::isfinite(b)) {
+            c = std::copysign(std::isinf(c) ? T(1) : T(0), c);
+            d = std::copysign(std::isinf(d) ? T(1) : T(0), d);
+            return Complex(T(0) * (a * c + b * d), T(0) * (b * c - a * d));
+        }
+        return Complex(e, f);
+    }
+};
+
+// usable in constant expressions
+static_assert((Complex<double>(1, 2) * Complex<double>(3, 4)) == Complex<double>(-5, 10), "constexpr multiplication");
+static_assert((Complex<double>(-5, 10) / Complex<double>(3, 4)) == Complex<double>(1, 2), "constexpr division");
+
+#endif //COMPLEXHEADER_COMPLEX_HPP
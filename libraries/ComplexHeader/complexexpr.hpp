@@ -0,0 +1,128 @@
+#ifndef COMPLEXHEADER_COMPLEXEXPR_HPP
+#define COMPLEXHEADER_COMPLEXEXPR_HPP
+
+#include "complex.hpp"
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+// expression templates over arrays of complex numbers
+// with an eager array type, C = A * B + D runs one loop per operator: A * B is computed into a temporary array, then the temporary
+// and D are added into another one, which is finally copied or moved into C. every operator reads and writes whole arrays, so on
+// large arrays the expression is limited by memory bandwidth, and most of the traffic is temporaries
+// here the operators do not compute anything - they return a small object describing the expression (which operands, which
+// operation). only the assignment to a ComplexVector runs a loop, evaluating the whole expression for one element at a time:
+// one pass, every operand read once, the result written once, and no temporary arrays. the loop body is fully inlined and works on
+// the separate real and imaginary arrays, so the compiler can vectorise it (GCC needs -O3 for that - the cheap cost model of -O2
+// gives up on loops which need a runtime overlap check)
+
+template<typename T> class ComplexVector;
+
+// CRTP base of every expression - lets the operators below accept any expression, and nothing else
+template<typename E>
+struct complexExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// leaves (ComplexVectors) are held by reference, inner nodes by value - a node is a temporary which dies at the end of the full
+// expression, while the vectors outlive it. this also means an expression must not be stored with 'auto' past that point
+template<typename E>
+struct exprStorage {
+    using type = E;
+};
+
+template<typename T>
+struct exprStorage<ComplexVector<T>> {
+    using type = const ComplexVector<T>&;
+};
+
+struct addOp {
+    template<typename T> static constexpr Complex<T> apply(const Complex<T>& a, const Complex<T>& b) noexcept { return a + b; }
+};
+
+struct subOp {
+    template<typename T> static constexpr Complex<T> apply(const Complex<T>& a, const Complex<T>& b) noexcept { return a - b; }
+};
+
+struct mulOp {
+    template<typename T> static constexpr Complex<T> apply(const Complex<T>& a, const Complex<T>& b) noexcept { return a * b; }
+};
+
+struct divOp {
+    template<typename T> static constexpr Complex<T> apply(const Complex<T>& a, const Complex<T>& b) noexcept { return a / b; }
+};
+
+template<typename L, typename R, typename Op>
+class binaryExpr : public complexExpr<binaryExpr<L, R, Op>> {
+    typename exprStorage<L>::type lhs;
+    typename exprStorage<R>::type rhs;
+
+public:
+    using value_type = typename L::value_type;
+
+    binaryExpr(const L& l, const R& r) : lhs(l), rhs(r) {
+        assert(lhs.size() == rhs.size());
+    }
+
+    std::size_t size() const { return lhs.size(); }
+    Complex<value_type> operator[](std::size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+};
+
+// an array in structure-of-arrays layout (like ComplexArray in ComplexShared), which can be assigned any expression
+template<typename T>
+class ComplexVector : public complexExpr<ComplexVector<T>> {
+    std::vector<T> re, im;
+
+public:
+    using value_type = T;
+
+    ComplexVector() = default;
+    explicit ComplexVector(std::size_t n) : re(n), im(n) {}
+
+    // evaluates the expression in one pass
+    template<typename E>
+    ComplexVector(const complexExpr<E>& expr) : ComplexVector(expr.self().size()) {
+        *this = expr;
+    }
+
+    // the destination may also be an operand (A = A * B + C) - element i only reads element i of each operand, so writing it
+    // afterwards is safe. the compiler cannot prove the arrays are distinct and checks for overlap once before the vectorised loop
+    template<typename E>
+    ComplexVector& operator=(const complexExpr<E>& expr) {
+        const E& e = expr.self();
+        std::size_t n = e.size();
+        re.resize(n);
+        im.resize(n);
+        T* outRe = re.data();
+        T* outIm = im.data();
+        for(std::size_t i = 0; i < n; i++) {
+            Complex<T> value = e[i];
+            outRe[i] = value.re;
+            outIm[i] = value.im;
+        }
+        return *this;
+    }
+
+    std::size_t size() const { return re.size(); }
+    Complex<T> operator[](std::size_t i) const { return Complex<T>(re[i], im[i]); }
+    void set(std::size_t i, const Complex<T>& value) { re[i] = value.re; im[i] = value.im; }
+
+    T* real() { return re.data(); }
+    T* imag() { return im.data(); }
+    const T* real() const { return re.data(); }
+    const T* imag() const { return im.data(); }
+};
+
+template<typename L, typename R>
+binaryExpr<L, R, addOp> operator+(const complexExpr<L>& l, const complexExpr<R>& r) { return {l.self(), r.self()}; }
+
+template<typename L, typename R>
+binaryExpr<L, R, subOp> operator-(const complexExpr<L>& l, const complexExpr<R>& r) { return {l.self(), r.self()}; }
+
+template<typename L, typename R>
+binaryExpr<L, R, mulOp> operator*(const complexExpr<L>& l, const complexExpr<R>& r) { return {l.self(), r.self()}; }
+
+template<typename L, typename R>
+binaryExpr<L, R, divOp> operator/(const complexExpr<L>& l, const complexExpr<R>& r) { return {l.self(), r.self()}; }
+
+#endif //COMPLEXHEADER_COMPLEXEXPR_HPP
@@ -0,0 +1,98 @@
+// fused (expression template) vs eager complex array arithmetic, on 3 to 6 operand expressions
+#include "complexexpr.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+// build with the CMake target ComplexExprBench, or by hand:
+//     g++ -std=c++17 -O3 -march=native exprbench.cpp -o exprbench
+// run with: ./exprbench [elements] [repeats]
+
+// the eager path - every operator runs its own loop into a new array, the way C = A * B + D works on arrays of ComplexShared
+// (an alias of Complex<double>). the loops are the ones of ComplexVector, one operator at a time, so the only difference with
+// the fused path is the temporaries
+struct eagerVector {
+    ComplexVector<double> v;
+};
+
+eagerVector operator+(const eagerVector& a, const eagerVector& b) { return {ComplexVector<double>(a.v + b.v)}; }
+eagerVector operator-(const eagerVector& a, const eagerVector& b) { return {ComplexVector<double>(a.v - b.v)}; }
+eagerVector operator*(const eagerVector& a, const eagerVector& b) { return {ComplexVector<double>(a.v * b.v)}; }
+
+ComplexVector<double> randomVector(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    ComplexVector<double> v(n);
+    for(std::size_t i = 0; i < n; i++) v.set(i, Complex<double>(dist(rng), dist(rng)));
+    return v;
+}
+
+bool sameValues(const ComplexVector<double>& a, const ComplexVector<double>& b) {
+    for(std::size_t i = 0; i < a.size(); i++) if(a[i] != b[i]) return false;
+    return true;
+}
+
+// one expression, evaluated both ways. 'operands' arrays are read and one written by the fused loop; the eager one makes
+// operands - 1 passes, each reading two arrays and writing one. the eager GB/s also comes out lower than the fused one: every
+// temporary is a fresh allocation, and at this size its pages are faulted in by the loop that first writes them
+template<typename Fused, typename Eager>
+bool run(const char* name, int operands, std::size_t n, int repeats, Fused fused, Eager eager) {
+    ComplexVector<double> out(n);
+    eagerVector eagerOut;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) fused(out);
+    std::chrono::duration<double> fusedTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) eagerOut = eager();
+    std::chrono::duration<double> eagerTime = std::chrono::steady_clock::now() - start;
+
+    const double bytesPerArray = double(n) * 2 * sizeof(double) * repeats;
+    double fusedBytes = (operands + 1) * bytesPerArray;
+    double eagerBytes = 3.0 * (operands - 1) * bytesPerArray;
+    bool same = sameValues(out, eagerOut.v);
+
+    std::cout << name << " (" << operands << " operands)" << (same ? "" : "  RESULTS DIFFER") << std::endl
+              << "  fused: " << fusedTime.count() * 1e3 / repeats << " ms, " << fusedBytes / 1e9 / repeats << " GB moved, "
+              << fusedBytes / fusedTime.count() / 1e9 << " GB/s" << std::endl
+              << "  eager: " << eagerTime.count() * 1e3 / repeats << " ms, " << eagerBytes / 1e9 / repeats << " GB moved, "
+              << eagerBytes / eagerTime.count() / 1e9 << " GB/s" << std::endl
+              << "  fused is " << eagerTime.count() / fusedTime.count() << "x faster" << std::endl;
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const eagerVector A{randomVector(n, 1)}, B{randomVector(n, 2)}, C{randomVector(n, 3)},
+                      D{randomVector(n, 4)}, E{randomVector(n, 5)}, F{randomVector(n, 6)};
+    const ComplexVector<double> &a = A.v, &b = B.v, &c = C.v, &d = D.v, &e = E.v, &f = F.v;
+
+    bool ok = true;
+    ok = run("A * B + C", 3, n, repeats,
+             [&](ComplexVector<double>& out) { out = a * b + c; },
+             [&] { return A * B + C; }) && ok;
+    ok = run("A * B + C * D", 4, n, repeats,
+             [&](ComplexVector<double>& out) { out = a * b + c * d; },
+             [&] { return A * B + C * D; }) && ok;
+    ok = run("A * B + C * D - E", 5, n, repeats,
+             [&](ComplexVector<double>& out) { out = a * b + c * d - e; },
+             [&] { return A * B + C * D - E; }) && ok;
+    ok = run("(A * B + C * D) * (E - F)", 6, n, repeats,
+             [&](ComplexVector<double>& out) { out = (a * b + c * d) * (e - f); },
+             [&] { return (A * B + C * D) * (E - F); }) && ok;
+
+    // the destination may be one of the operands
+    ComplexVector<double> inPlace = a;
+    inPlace = inPlace * b + c;
+    ComplexVector<double> expected = a * b + c;
+    bool sameInPlace = sameValues(inPlace, expected);
+    std::cout << "A = A * B + C in place: " << (sameInPlace ? "ok" : "RESULTS DIFFER") << std::endl;
+    ok = sameInPlace && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// throughput benchmark - ComplexArray operations against a loop over ComplexStatic samples
+#include "library.hpp"
+#include "../ComplexStatic/library.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+// build with the CMake target ComplexArrayBench, or by hand (each kernel file has its own flags):
+//     g++ -std=c++17 -O2 -ffp-contract=off -c kernelsavx2.cpp -mavx2
+//     g++ -std=c++17 -O2 -ffp-contract=off -c kernelsavx512.cpp -mavx512f
+//     g++ -std=c++17 -O2 -ffp-contract=off bench.cpp library.cpp kernelssse2.cpp kernels*.o -o bench
+// run with: ./bench [samples] [repeats]
+
+template<typename Body>
+double samplesPerSecond(std::size_t n, int repeats, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(n) * repeats / elapsed.count();
+}
+
+void report(const char* name, double staticRate, double arrayRate) {
+    std::cout << name << "ComplexStatic " << staticRate / 1e6 << " M samples/s, ComplexArray " << arrayRate / 1e6
+              << " M samples/s (x" << arrayRate / staticRate << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    std::vector<ComplexStatic> sa(n), sb(n), sout(n);
+    std::vector<double> smag(n), amag;
+    ComplexArray a(n), b(n), out(n);
+    for(std::size_t i = 0; i < n; i++) {
+        sa[i] = ComplexStatic(dist(rng), dist(rng));
+        sb[i] = ComplexStatic(dist(rng), dist(rng));
+        a.set(i, ComplexShared(sa[i].re, sa[i].im));
+        b.set(i, ComplexShared(sb[i].re, sb[i].im));
+    }
+
+    std::cout << "samples: " << n << ", array kernels: " << SharedLib::arrayKernels() << std::endl;
+
+    report("add       : ", samplesPerSecond(n, repeats, [&] { for(std::size_t i = 0; i < n; i++) sout[i] = sa[i] + sb[i]; }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::add(a, b, out); }));
+    report("sub       : ", samplesPerSecond(n, repeats, [&] { for(std::size_t i = 0; i < n; i++) sout[i] = sa[i] - sb[i]; }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::sub(a, b, out); }));
+    report("mul       : ", samplesPerSecond(n, repeats, [&] { for(std::size_t i = 0; i < n; i++) sout[i] = sa[i] * sb[i]; }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::mul(a, b, out); }));
+    report("div       : ", samplesPerSecond(n, repeats, [&] { for(std::size_t i = 0; i < n; i++) sout[i] = sa[i] / sb[i]; }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::div(a, b, out); }));
+    report("conjugate : ", samplesPerSecond(n, repeats, [&] {
+                               for(std::size_t i = 0; i < n; i++) sout[i] = ComplexStatic(sa[i].re, -sa[i].im);
+                           }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::conjugate(a, out); }));
+    report("magnitude : ", samplesPerSecond(n, repeats, [&] {
+                               for(std::size_t i = 0; i < n; i++) smag[i] = std::sqrt(sa[i].re * sa[i].re + sa[i].im * sa[i].im);
+                           }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::magnitude(a, amag); }));
+    report("scale     : ", samplesPerSecond(n, repeats, [&] {
+                               for(std::size_t i = 0; i < n; i++) sout[i] = ComplexStatic(sa[i].re * 0.5, sa[i].im * 0.5);
+                           }),
+                           samplesPerSecond(n, repeats, [&] { SharedLib::scale(a, 0.5, out); }));
+
+    // the two paths have to agree - checked on division, the operation with the most arithmetic
+    SharedLib::div(a, b, out);
+    double maxError = 0;
+    for(std::size_t i = 0; i < n; i++) {
+        ComplexStatic expected = sa[i] / sb[i];
+        maxError = std::max(maxError, std::abs(out.real()[i] - expected.re) + std::abs(out.imag()[i] - expected.im));
+    }
+    std::cout << "max difference in division: " << maxError << std::endl;
+
+    return maxError < 1e-9 ? 0 : 1;
+}
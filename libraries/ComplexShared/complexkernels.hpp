@@ -0,0 +1,249 @@
+#ifndef COMPLEXSHARED_COMPLEXKERNELS_HPP
+#define COMPLEXSHARED_COMPLEXKERNELS_HPP
+
+#include <cstddef>
+#include <cmath>
+#if defined(__SSE2__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// the elementwise kernels behind ComplexArray, written once against a small set of vector operations ('Ops') and instantiated for
+// every instruction set the file is compiled for:
+// - scalarOps works on one double at a time and is always available
+// - sse2Ops works on 2 doubles (__m128d), avx2Ops on 4 (__m256d), avx512Ops on 8 (__m512d) - only defined when the compiler targets
+//   those instruction sets
+// with the structure-of-arrays layout the real and imaginary parts come from separate arrays, so a vector register holds the same
+// part of 2, 4 or 8 consecutive samples and no shuffling is needed. the tail that does not fill a whole register goes through
+// scalarOps
+namespace ComplexKernels {
+
+// one entry per array operation of SharedLib. every instruction set gets its own table, in a file compiled for it (kernels*.cpp,
+// see CMakeLists.txt), and library.cpp picks the one to use on first use
+struct kernelTable {
+    const char* name;
+    void (*add)(const double*, const double*, const double*, const double*, double*, double*, std::size_t);
+    void (*sub)(const double*, const double*, const double*, const double*, double*, double*, std::size_t);
+    void (*mul)(const double*, const double*, const double*, const double*, double*, double*, std::size_t);
+    void (*div)(const double*, const double*, const double*, const double*, double*, double*, std::size_t);
+    void (*divReciprocal)(const double*, const double*, const double*, const double*, double*, double*, std::size_t);
+    void (*conjugate)(const double*, const double*, double*, double*, std::size_t);
+    void (*magnitude)(const double*, const double*, double*, std::size_t);
+    void (*scale)(const double*, const double*, double, double*, double*, std::size_t);
+};
+
+extern const kernelTable scalarTable;
+#if defined(__x86_64__)
+extern const kernelTable sse2Table, avx2Table, avx512Table;
+#endif
+
+// the Annex G slow path of div - in library.cpp, which is compiled for the baseline instruction set
+void divideOne(double a, double b, double c, double d, double* e, double* f);
+
+// everything below is compiled once per instruction set, by files built with different flags. the unnamed namespace keeps every
+// copy local to its file: with external linkage the linker would keep a single copy of, say, add<scalarOps> - possibly the one
+// compiled with -mavx512f, which would then crash the scalar path on a CPU without AVX-512
+namespace {
+
+struct scalarOps {
+    using reg = double;
+    static constexpr std::size_t width = 1;
+    static reg load(const double* p) { return *p; }
+    static void store(double* p, reg v) { *p = v; }
+    static reg set1(double v) { return v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg div(reg a, reg b) { return a / b; }
+    static reg sqrt(reg a) { return std::sqrt(a); }
+    static reg neg(reg a) { return -a; }
+    static reg abs(reg a) { return std::fabs(a); }
+    // comparisons give a 'mask' with one flag per lane, which 'select' uses to pick between two registers lane by lane
+    using mask = bool;
+    static mask less(reg a, reg b) { return a < b; }
+    static reg select(mask m, reg ifTrue, reg ifFalse) { return m ? ifTrue : ifFalse; }
+    static mask bothNaN(reg a, reg b) { return a != a && b != b; }
+    static bool any(mask m) { return m; }
+};
+
+#ifdef __SSE2__
+struct sse2Ops {
+    using reg = __m128d;
+    static constexpr std::size_t width = 2;
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+    static reg sqrt(reg a) { return _mm_sqrt_pd(a); }
+    static reg neg(reg a) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+    static reg abs(reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    using mask = __m128d;
+    static mask less(reg a, reg b) { return _mm_cmplt_pd(a, b); }
+    // no blend instruction before SSE4.1 - the lanes are picked with and/andnot/or on the all-ones or all-zeros mask
+    static reg select(mask m, reg ifTrue, reg ifFalse) { return _mm_or_pd(_mm_and_pd(m, ifTrue), _mm_andnot_pd(m, ifFalse)); }
+    static mask bothNaN(reg a, reg b) { return _mm_and_pd(_mm_cmpunord_pd(a, a), _mm_cmpunord_pd(b, b)); }
+    static bool any(mask m) { return _mm_movemask_pd(m) != 0; }
+};
+#endif
+
+#ifdef __AVX2__
+struct avx2Ops {
+    using reg = __m256d;
+    static constexpr std::size_t width = 4;
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm256_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+    static reg sqrt(reg a) { return _mm256_sqrt_pd(a); }
+    static reg neg(reg a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    static reg abs(reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    using mask = __m256d;
+    static mask less(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static reg select(mask m, reg ifTrue, reg ifFalse) { return _mm256_blendv_pd(ifFalse, ifTrue, m); }
+    static mask bothNaN(reg a, reg b) { return _mm256_and_pd(_mm256_cmp_pd(a, a, _CMP_UNORD_Q), _mm256_cmp_pd(b, b, _CMP_UNORD_Q)); }
+    static bool any(mask m) { return _mm256_movemask_pd(m) != 0; }
+};
+#endif
+
+#ifdef __AVX512F__
+struct avx512Ops {
+    using reg = __m512d;
+    static constexpr std::size_t width = 8;
+    static reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm512_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm512_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+    // the masked form with every lane enabled - GCC warns about the undefined source register inside _mm512_sqrt_pd
+    static reg sqrt(reg a) { return _mm512_mask_sqrt_pd(a, 0xFF, a); }
+    static reg neg(reg a) { return _mm512_sub_pd(_mm512_setzero_pd(), a); }
+    static reg abs(reg a) { return _mm512_abs_pd(a); }
+    using mask = __mmask8;
+    static mask less(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static reg select(mask m, reg ifTrue, reg ifFalse) { return _mm512_mask_blend_pd(m, ifFalse, ifTrue); }
+    static mask bothNaN(reg a, reg b) { return _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q) & _mm512_cmp_pd_mask(b, b, _CMP_UNORD_Q); }
+    static bool any(mask m) { return m != 0; }
+};
+#endif
+
+// runs 'body' over [0, n) - whole registers with Ops, then the remainder one element at a time with scalarOps
+template<typename Ops, typename Body>
+inline void forEachBlock(std::size_t n, Body body) {
+    std::size_t i = 0;
+    for(; i + Ops::width <= n; i += Ops::width) body(Ops(), i);
+    for(; i < n; i++) body(scalarOps(), i);
+}
+
+template<typename Ops>
+void add(const double* ar, const double* ai, const double* br, const double* bi, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        O::store(outr + i, O::add(O::load(ar + i), O::load(br + i)));
+        O::store(outi + i, O::add(O::load(ai + i), O::load(bi + i)));
+    });
+}
+
+template<typename Ops>
+void sub(const double* ar, const double* ai, const double* br, const double* bi, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        O::store(outr + i, O::sub(O::load(ar + i), O::load(br + i)));
+        O::store(outi + i, O::sub(O::load(ai + i), O::load(bi + i)));
+    });
+}
+
+// (a + bi)(c + di) = (ac - bd) + (ad + bc)i
+template<typename Ops>
+void mul(const double* ar, const double* ai, const double* br, const double* bi, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        auto a = O::load(ar + i), b = O::load(ai + i), c = O::load(br + i), d = O::load(bi + i);
+        O::store(outr + i, O::sub(O::mul(a, c), O::mul(b, d)));
+        O::store(outi + i, O::add(O::mul(a, d), O::mul(b, c)));
+    });
+}
+
+// smith's algorithm, the same formula as ComplexShared::operator/: each lane picks the larger part of the divisor as 'p' and the
+// other as 'q', and the operands are swapped to match, so one formula serves both cases
+//   r = q / p, den = p + q r, e = (x + y r) / den, f = +-(y - x r) / den
+// with reciprocal = true den is inverted once and the two parts multiplied by the inverse - one division less per sample, for up
+// to one more rounding error in each part. lanes which come out as NaN + NaN i (a zero, infinite or NaN operand) are redone
+// with operator/ (through divideOne), which applies the special cases of C99 Annex G - the vector path only handles the common,
+// finite case
+template<typename Ops, bool reciprocal = false>
+void div(const double* ar, const double* ai, const double* br, const double* bi, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        auto a = O::load(ar + i), b = O::load(ai + i), c = O::load(br + i), d = O::load(bi + i);
+        auto swap = O::less(O::abs(c), O::abs(d));
+        auto p = O::select(swap, d, c), q = O::select(swap, c, d);
+        auto x = O::select(swap, b, a), y = O::select(swap, a, b);
+        auto r = O::div(q, p);
+        auto den = O::add(p, O::mul(q, r));
+        auto xr = O::mul(x, r);
+        auto eNum = O::add(x, O::mul(y, r)), fNum = O::select(swap, O::sub(xr, y), O::sub(y, xr));
+        decltype(a) e, f;
+        if constexpr(reciprocal) {
+            auto inv = O::div(O::set1(1.0), den);
+            e = O::mul(eNum, inv);
+            f = O::mul(fNum, inv);
+        } else {
+            e = O::div(eNum, den);
+            f = O::div(fNum, den);
+        }
+        // nothing is stored before the check - with out == a or b the inputs of the block are still intact for the redo
+        if(O::any(O::bothNaN(e, f))) {
+            for(std::size_t j = i; j < i + O::width; j++) divideOne(ar[j], ai[j], br[j], bi[j], outr + j, outi + j);
+            return;
+        }
+        O::store(outr + i, e);
+        O::store(outi + i, f);
+    });
+}
+
+template<typename Ops>
+void conjugate(const double* ar, const double* ai, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        O::store(outr + i, O::load(ar + i));
+        O::store(outi + i, O::neg(O::load(ai + i)));
+    });
+}
+
+// |a + bi| = sqrt(a*a + b*b) - like the scalar operators this does not guard against overflow of the squares
+template<typename Ops>
+void magnitude(const double* ar, const double* ai, double* out, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        auto a = O::load(ar + i), b = O::load(ai + i);
+        O::store(out + i, O::sqrt(O::add(O::mul(a, a), O::mul(b, b))));
+    });
+}
+
+template<typename Ops>
+void scale(const double* ar, const double* ai, double factor, double* outr, double* outi, std::size_t n) {
+    forEachBlock<Ops>(n, [=](auto ops, std::size_t i) {
+        using O = decltype(ops);
+        auto f = O::set1(factor);
+        O::store(outr + i, O::mul(O::load(ar + i), f));
+        O::store(outi + i, O::mul(O::load(ai + i), f));
+    });
+}
+
+template<typename Ops>
+constexpr kernelTable makeTable(const char* name) {
+    return {name, add<Ops>, sub<Ops>, mul<Ops>, div<Ops>, div<Ops, true>, conjugate<Ops>, magnitude<Ops>, scale<Ops>};
+}
+
+}
+
+}
+
+#endif //COMPLEXSHARED_COMPLEXKERNELS_HPP
@@ -0,0 +1,157 @@
+// runtime kernel selection - checks every kernel set this CPU can run against the ComplexShared operators, and times each of them
+#include "library.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+// build with the CMake target DispatchBench (the kernel files need their own flags)
+// run with: ./dispatchbench [samples] [repeats]
+// COMPLEX_KERNELS=sse2 ./dispatchbench starts on the SSE2 kernels instead of the widest ones - the check below forces each set
+// in turn with SharedLib::useKernels either way
+
+// every kernel set does the same operations in the same order, with FMA contraction off (see CMakeLists.txt), so its results
+// have to be bitwise identical to the ComplexShared operators - NaNs only have to be NaN. the reciprocal division is the one exception: it
+// rounds differently from operator/ by design, so it gets a tolerance relative to the size of the whole complex result
+bool matches(double got, double want, double tolerance) {
+    if(std::isnan(want)) return std::isnan(got);
+    if(tolerance == 0 || !std::isfinite(tolerance)) return std::memcmp(&got, &want, sizeof(double)) == 0;
+    return std::fabs(got - want) <= tolerance;
+}
+
+bool matches(const ComplexArray& got, const std::vector<ComplexShared>& want, double relativeTolerance) {
+    for(std::size_t i = 0; i < want.size(); i++) {
+        double size = std::fabs(want[i].re) + std::fabs(want[i].im);
+        double tolerance = relativeTolerance == 0 ? 0 : relativeTolerance * size;
+        if(!matches(got.real()[i], want[i].re, tolerance) || !matches(got.imag()[i], want[i].im, tolerance)) return false;
+    }
+    return true;
+}
+
+// every operation on an odd size, so that the scalar tail after the last whole register runs too, with a few zero, infinite and
+// NaN divisors mixed in for the Annex G path of division
+bool check(const char* name) {
+    const std::size_t n = 1003;
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    ComplexArray a(n), b(n), out;
+    for(std::size_t i = 0; i < n; i++) {
+        a.set(i, ComplexShared(dist(rng), dist(rng)));
+        b.set(i, ComplexShared(dist(rng), dist(rng)));
+    }
+    b.set(5, ComplexShared(0, 0));
+    b.set(17, ComplexShared(inf, 1));
+    b.set(n - 1, ComplexShared(0, 0));
+    a.set(40, ComplexShared(inf, nan));
+
+    std::vector<ComplexShared> want(n);
+    bool ok = true;
+    auto expect = [&](const char* op, auto reference, double relativeTolerance = 0) {
+        for(std::size_t i = 0; i < n; i++) want[i] = reference(a.get(i), b.get(i));
+        if(matches(out, want, relativeTolerance)) return;
+        std::cout << "  " << name << " " << op << " differs from the ComplexShared operators" << std::endl;
+        ok = false;
+    };
+
+    SharedLib::add(a, b, out);
+    expect("add", [](ComplexShared x, ComplexShared y) { return x + y; });
+    SharedLib::sub(a, b, out);
+    expect("sub", [](ComplexShared x, ComplexShared y) { return x - y; });
+    SharedLib::mul(a, b, out);
+    expect("mul", [](ComplexShared x, ComplexShared y) { return x * y; });
+    SharedLib::div(a, b, out);
+    expect("div", [](ComplexShared x, ComplexShared y) { return x / y; });
+    SharedLib::div(a, b, out, SharedLib::DivisionMode::reciprocal);
+    expect("div (reciprocal)", [](ComplexShared x, ComplexShared y) { return x / y; }, 4 * std::numeric_limits<double>::epsilon());
+    SharedLib::conjugate(a, out);
+    expect("conjugate", [](ComplexShared x, ComplexShared) { return ComplexShared(x.re, -x.im); });
+    SharedLib::scale(a, 0.5, out);
+    expect("scale", [](ComplexShared x, ComplexShared) { return ComplexShared(x.re * 0.5, x.im * 0.5); });
+
+    // z * conj(z) is real - ac - bd and ad + bc cancel exactly unless one of the products was fused into an FMA
+    ComplexArray conjugated, product;
+    SharedLib::conjugate(a, conjugated);
+    SharedLib::mul(a, conjugated, product);
+    for(std::size_t i = 0; i < n; i++) {
+        if(product.imag()[i] == 0 || std::isnan(product.imag()[i])) continue;
+        std::cout << "  " << name << " z * conj(z) has an imaginary part" << std::endl;
+        ok = false;
+        break;
+    }
+
+    std::vector<double> magnitudes;
+    SharedLib::magnitude(a, magnitudes);
+    for(std::size_t i = 0; i < n; i++) {
+        double expected = std::sqrt(a.real()[i] * a.real()[i] + a.imag()[i] * a.imag()[i]);
+        if(matches(magnitudes[i], expected, 0)) continue;
+        std::cout << "  " << name << " magnitude differs from the scalar formula" << std::endl;
+        ok = false;
+        break;
+    }
+    return ok;
+}
+
+template<typename Body>
+double samplesPerSecond(std::size_t n, int repeats, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(n) * repeats / elapsed.count();
+}
+
+void benchmark(const char* name, std::size_t n, int repeats) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    ComplexArray a(n), b(n), out(n);
+    std::vector<double> magnitudes(n);
+    for(std::size_t i = 0; i < n; i++) {
+        a.set(i, ComplexShared(dist(rng), dist(rng)));
+        b.set(i, ComplexShared(dist(rng), dist(rng)));
+    }
+    auto rate = [&](auto body) { return samplesPerSecond(n, repeats, body) / 1e6; };
+    std::cout << name << "\t"
+              << rate([&] { SharedLib::add(a, b, out); }) << "\t"
+              << rate([&] { SharedLib::mul(a, b, out); }) << "\t"
+              << rate([&] { SharedLib::div(a, b, out); }) << "\t"
+              << rate([&] { SharedLib::div(a, b, out, SharedLib::DivisionMode::reciprocal); }) << "\t"
+              << rate([&] { SharedLib::magnitude(a, magnitudes); }) << "\t"
+              << rate([&] { SharedLib::scale(a, 0.5, out); }) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 16;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    const char* selected = SharedLib::arrayKernels();
+    std::vector<const char*> available = SharedLib::availableKernels();
+    std::cout << "selected: " << selected << ", available:";
+    for(const char* name : available) std::cout << " " << name;
+    std::cout << std::endl;
+
+    bool ok = true;
+    if(SharedLib::useKernels("no-such-kernels")) {
+        std::cout << "  an unknown kernel name was accepted" << std::endl;
+        ok = false;
+    }
+    for(const char* name : available) {
+        bool forced = SharedLib::useKernels(name) && std::strcmp(SharedLib::arrayKernels(), name) == 0;
+        bool same = forced && check(name);
+        std::cout << "forced " << name << ": " << (!forced ? "could not switch" : same ? "ok" : "FAILED") << std::endl;
+        ok = same && ok;
+    }
+
+    std::cout << "M samples/s\tadd\tmul\tdiv\tdiv 1/x\t|z|\tscale" << std::endl;
+    for(const char* name : available) {
+        SharedLib::useKernels(name);
+        benchmark(name, n, repeats);
+    }
+    SharedLib::useKernels(selected);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// complex division - accuracy (ULP error against a 113-bit reference), C99 Annex G special values, and throughput
+#include "library.hpp"
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+
+// build with the CMake target DivisionBench, or by hand (each kernel file has its own flags):
+//     g++ -std=c++17 -O2 -ffp-contract=off -c kernelsavx2.cpp -mavx2
+//     g++ -std=c++17 -O2 -ffp-contract=off -c kernelsavx512.cpp -mavx512f
+//     g++ -std=c++17 -O2 -ffp-contract=off divbench.cpp library.cpp kernelssse2.cpp kernels*.o -o divbench
+// run with: ./divbench [samples] [repeats]
+
+// the formula operator/ used before - kept here to show what smith's algorithm fixes
+ComplexShared textbookDivision(const ComplexShared& x, const ComplexShared& y) {
+    double den = y.re * y.re + y.im * y.im;
+    return ComplexShared((x.re * y.re + x.im * y.im) / den, (x.im * y.re - x.re * y.im) / den);
+}
+
+// the reference quotient in __float128: the products of two doubles are exact in its 113-bit mantissa, so the textbook formula
+// only rounds once in each numerator and once in the denominator, and its exponent range cannot overflow for double operands
+struct quadComplex {
+    __float128 re, im;
+};
+
+quadComplex referenceDivision(const ComplexShared& x, const ComplexShared& y) {
+    __float128 a = x.re, b = x.im, c = y.re, d = y.im;
+    __float128 den = c * c + d * d;
+    return {(a * c + b * d) / den, (b * c - a * d) / den};
+}
+
+__float128 quadAbs(__float128 v) { return v < 0 ? -v : v; }
+
+// the distance to the next double away from zero - the unit in the last place of 'v'
+double ulp(double v) {
+    v = std::fabs(v);
+    if(v == std::numeric_limits<double>::max()) return v - std::nextafter(v, 0.0);
+    return std::nextafter(v, std::numeric_limits<double>::infinity()) - v;
+}
+
+// error of 'computed' against the exact 'reference', in units of the last place of the reference rounded to double
+double ulpError(double computed, __float128 reference) {
+    if(!std::isfinite(computed)) return std::numeric_limits<double>::infinity();
+    return double(quadAbs(__float128(computed) - reference) / __float128(ulp(double(reference))));
+}
+
+// componentwise: the worse of the two parts, each measured in its own ulps - a part much smaller than the other one can have a
+// large relative error through cancellation, for any of the algorithms. normwise: the error of the whole quotient in ulps of its
+// larger part, which is what smith's algorithm bounds
+struct errors {
+    double componentwise = 0, normwise = 0;
+    std::size_t nonFinite = 0;
+};
+
+void accumulate(errors& err, const ComplexShared& q, const quadComplex& ref) {
+    if(!std::isfinite(q.re) || !std::isfinite(q.im)) {
+        err.nonFinite++;
+        return;
+    }
+    err.componentwise = std::max({err.componentwise, ulpError(q.re, ref.re), ulpError(q.im, ref.im)});
+    double larger = std::max(std::fabs(double(ref.re)), std::fabs(double(ref.im)));
+    __float128 distance = std::max(quadAbs(__float128(q.re) - ref.re), quadAbs(__float128(q.im) - ref.im));
+    err.normwise = std::max(err.normwise, double(distance / __float128(ulp(larger))));
+}
+
+void printErrors(const char* name, const errors& err) {
+    std::cout << name << "max " << err.componentwise << " ulp componentwise, " << err.normwise << " ulp normwise, "
+              << err.nonFinite << " overflowed or NaN" << std::endl;
+}
+
+// the corpus: parts with a random sign and an exponent drawn from [-range, range], so that with a wide range the operands reach
+// the sizes where c*c + d*d overflows or underflows. pairs whose exact quotient is not a normal double are skipped
+void makeCorpus(std::size_t n, int range, unsigned seed, ComplexArray& x, ComplexArray& y, std::vector<quadComplex>& reference) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> mantissa(1.0, 2.0), exponent(-range, range);
+    auto part = [&] { return (rng() & 1 ? -1.0 : 1.0) * std::ldexp(mantissa(rng), int(exponent(rng))); };
+    std::vector<ComplexShared> xs, ys;
+    reference.clear();
+    while(reference.size() < n) {
+        ComplexShared a(part(), part()), b(part(), part());
+        quadComplex q = referenceDivision(a, b);
+        double larger = std::max(std::fabs(double(q.re)), std::fabs(double(q.im)));
+        if(!(larger >= std::numeric_limits<double>::min() && larger <= std::numeric_limits<double>::max())) continue;
+        xs.push_back(a);
+        ys.push_back(b);
+        reference.push_back(q);
+    }
+    x = ComplexArray(n);
+    y = ComplexArray(n);
+    for(std::size_t i = 0; i < n; i++) {
+        x.set(i, xs[i]);
+        y.set(i, ys[i]);
+    }
+}
+
+void accuracy(std::size_t n, int range) {
+    ComplexArray x, y, out;
+    std::vector<quadComplex> reference;
+    makeCorpus(n, range, unsigned(range), x, y, reference);
+    std::cout << n << " random quotients, parts between 2^-" << range << " and 2^" << range << ":" << std::endl;
+
+    errors textbook, scalar, smith, reciprocal;
+    for(std::size_t i = 0; i < n; i++) {
+        accumulate(textbook, textbookDivision(x.get(i), y.get(i)), reference[i]);
+        accumulate(scalar, x.get(i) / y.get(i), reference[i]);
+    }
+    SharedLib::div(x, y, out);
+    for(std::size_t i = 0; i < n; i++) accumulate(smith, out.get(i), reference[i]);
+    SharedLib::div(x, y, out, SharedLib::DivisionMode::reciprocal);
+    for(std::size_t i = 0; i < n; i++) accumulate(reciprocal, out.get(i), reference[i]);
+
+    printErrors("  textbook formula      : ", textbook);
+    printErrors("  operator/ (smith)     : ", scalar);
+    printErrors("  array, smith          : ", smith);
+    printErrors("  array, reciprocal     : ", reciprocal);
+}
+
+// the special values, against the built-in complex division of the compiler (__divdc3 in libgcc, which implements Annex G).
+// results are compared by kind, as Annex G specifies them: infinite if either part is, else NaN if either part is, else zero or
+// finite - the sign and the other part of an infinity are not specified. an operand which is NaN without being infinite (a NaN
+// part, no infinite part) gives an unspecified result, so those pairs are left out
+const char* kind(double re, double im) {
+    if(std::isinf(re) || std::isinf(im)) return "infinite";
+    if(std::isnan(re) || std::isnan(im)) return "NaN";
+    if(re == 0 && im == 0) return "zero";
+    return "finite";
+}
+
+bool isNaN(double re, double im) { return (std::isnan(re) || std::isnan(im)) && !std::isinf(re) && !std::isinf(im); }
+
+bool annexG() {
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    const double values[] = {0.0, -0.0, 1.0, -2.5, 1e300, 1e-300, inf, -inf, nan};
+    std::vector<ComplexShared> xs, ys;
+    for(double a : values) for(double b : values) for(double c : values) for(double d : values) {
+        if(isNaN(a, b) || isNaN(c, d)) continue;
+        xs.emplace_back(a, b);
+        ys.emplace_back(c, d);
+    }
+    std::size_t n = xs.size();
+    ComplexArray x(n), y(n), smith, reciprocal;
+    for(std::size_t i = 0; i < n; i++) {
+        x.set(i, xs[i]);
+        y.set(i, ys[i]);
+    }
+    SharedLib::div(x, y, smith);
+    SharedLib::div(x, y, reciprocal, SharedLib::DivisionMode::reciprocal);
+
+    std::size_t mismatches = 0;
+    for(std::size_t i = 0; i < n; i++) {
+        std::complex<double> expected = std::complex<double>(xs[i].re, xs[i].im) / std::complex<double>(ys[i].re, ys[i].im);
+        const char* want = kind(expected.real(), expected.imag());
+        ComplexShared scalar = xs[i] / ys[i];
+        const char* got[] = {kind(scalar.re, scalar.im), kind(smith.real()[i], smith.imag()[i]),
+                             kind(reciprocal.real()[i], reciprocal.imag()[i])};
+        for(const char* g : got) {
+            if(g == want) continue;
+            if(mismatches++ < 10) {
+                std::cout << "  (" << xs[i].re << ", " << xs[i].im << ") / (" << ys[i].re << ", " << ys[i].im << "): " << g
+                          << ", expected " << want << std::endl;
+            }
+        }
+    }
+    std::cout << "Annex G special values: " << n << " pairs, " << mismatches << " mismatches" << std::endl;
+    return mismatches == 0;
+}
+
+template<typename Body>
+double divisionsPerSecond(std::size_t n, int repeats, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return double(n) * repeats / elapsed.count();
+}
+
+void throughput(std::size_t n, int repeats) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    std::vector<ComplexShared> xs(n), ys(n), qs(n);
+    ComplexArray x(n), y(n), out(n);
+    for(std::size_t i = 0; i < n; i++) {
+        xs[i] = ComplexShared(dist(rng), dist(rng));
+        ys[i] = ComplexShared(dist(rng), dist(rng));
+        x.set(i, xs[i]);
+        y.set(i, ys[i]);
+    }
+
+    std::cout << "throughput on " << n << " samples (array kernels: " << SharedLib::arrayKernels() << "):" << std::endl;
+    auto print = [](const char* name, double rate) { std::cout << name << rate / 1e6 << " M divisions/s" << std::endl; };
+    // nothing reads qs afterwards, so without this the compiler keeps only the last repeat of the inlined loops (or none of them)
+    auto keep = [&] { asm volatile("" : : "r"(qs.data()) : "memory"); };
+    print("  textbook formula      : ", divisionsPerSecond(n, repeats, [&] {
+        for(std::size_t i = 0; i < n; i++) qs[i] = textbookDivision(xs[i], ys[i]);
+        keep();
+    }));
+    print("  operator/ (smith)     : ", divisionsPerSecond(n, repeats, [&] {
+        for(std::size_t i = 0; i < n; i++) qs[i] = xs[i] / ys[i];
+        keep();
+    }));
+    print("  std::complex (Annex G): ", divisionsPerSecond(n, repeats, [&] {
+        for(std::size_t i = 0; i < n; i++) {
+            std::complex<double> q = std::complex<double>(xs[i].re, xs[i].im) / std::complex<double>(ys[i].re, ys[i].im);
+            qs[i] = ComplexShared(q.real(), q.imag());
+        }
+        keep();
+    }));
+    print("  array, smith          : ", divisionsPerSecond(n, repeats, [&] { SharedLib::div(x, y, out); }));
+    print("  array, reciprocal     : ", divisionsPerSecond(n, repeats, [&] {
+        SharedLib::div(x, y, out, SharedLib::DivisionMode::reciprocal);
+    }));
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    accuracy(n, 8);
+    accuracy(n, 1000);
+    bool ok = annexG();
+    throughput(n, repeats);
+
+    return ok ? 0 : 1;
+}
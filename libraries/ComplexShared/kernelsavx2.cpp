@@ -0,0 +1,8 @@
+// the AVX2 kernels - compiled with -mavx2 (see CMakeLists.txt), and only called by library.cpp on CPUs which have it
+#include "complexkernels.hpp"
+
+#ifndef __AVX2__
+#error "kernelsavx2.cpp has to be compiled for AVX2 - see CMakeLists.txt"
+#endif
+
+const ComplexKernels::kernelTable ComplexKernels::avx2Table = ComplexKernels::makeTable<ComplexKernels::avx2Ops>("avx2");
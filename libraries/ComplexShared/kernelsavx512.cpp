@@ -0,0 +1,8 @@
+// the AVX-512 kernels - compiled with -mavx512f (see CMakeLists.txt), and only called by library.cpp on CPUs which have it
+#include "complexkernels.hpp"
+
+#ifndef __AVX512F__
+#error "kernelsavx512.cpp has to be compiled for AVX-512 - see CMakeLists.txt"
+#endif
+
+const ComplexKernels::kernelTable ComplexKernels::avx512Table = ComplexKernels::makeTable<ComplexKernels::avx512Ops>("avx512");
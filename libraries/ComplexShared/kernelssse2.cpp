@@ -0,0 +1,8 @@
+// the SSE2 kernels - SSE2 is part of x86-64, so this file needs no extra flags and its kernels run on any 64-bit x86 CPU
+#include "complexkernels.hpp"
+
+#ifndef __SSE2__
+#error "kernelssse2.cpp has to be compiled for SSE2 - see CMakeLists.txt"
+#endif
+
+const ComplexKernels::kernelTable ComplexKernels::sse2Table = ComplexKernels::makeTable<ComplexKernels::sse2Ops>("sse2");
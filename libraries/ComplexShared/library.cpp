@@ -1,45 +1,185 @@
 #include "library.hpp"
+#include "complexkernels.hpp"
 #include <iostream>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
 
 void SharedLib::printMessage() {
     std::cout << "This is ComplexShared library!" << std::endl;
 }
 
-ComplexShared::ComplexShared() : ComplexShared(0, 0) {}
-ComplexShared::ComplexShared(double r, double i) : re{r}, im{i} {}
+// the arrays are 64-byte aligned, so a full AVX-512 register never straddles two cache lines
+static double* allocateArray(std::size_t n) {
+    return n ? static_cast<double*>(::operator new(n * sizeof(double), std::align_val_t(64))) : nullptr;
+}
+
+static void freeArray(double* ptr) {
+    if(ptr) ::operator delete(ptr, std::align_val_t(64));
+}
+
+ComplexArray::ComplexArray() : ComplexArray(0) {}
+
+ComplexArray::ComplexArray(std::size_t n) : re{allocateArray(n)}, im{nullptr}, n{n} {
+    try {
+        im = allocateArray(n);
+    } catch(...) {
+        freeArray(re);
+        throw;
+    }
+    std::fill(re, re + n, 0.0);
+    std::fill(im, im + n, 0.0);
+}
+
+ComplexArray::ComplexArray(const ComplexArray &other) : ComplexArray(other.n) {
+    std::copy(other.re, other.re + n, re);
+    std::copy(other.im, other.im + n, im);
+}
+
+ComplexArray::ComplexArray(ComplexArray &&other) noexcept
+    : re{std::exchange(other.re, nullptr)}, im{std::exchange(other.im, nullptr)}, n{std::exchange(other.n, 0)} {}
+
+ComplexArray& ComplexArray::operator=(ComplexArray other) noexcept {
+    std::swap(re, other.re);
+    std::swap(im, other.im);
+    std::swap(n, other.n);
+    return *this;
+}
+
+ComplexArray::~ComplexArray() {
+    freeArray(re);
+    freeArray(im);
+}
+
+const ComplexKernels::kernelTable ComplexKernels::scalarTable = ComplexKernels::makeTable<ComplexKernels::scalarOps>("scalar");
+
+void ComplexKernels::divideOne(double a, double b, double c, double d, double* e, double* f) {
+    ComplexShared q = ComplexShared(a, b) / ComplexShared(c, d);
+    *e = q.re;
+    *f = q.im;
+}
+
+// every kernel table built into the library, widest first
+static const ComplexKernels::kernelTable* const allKernels[] = {
+#if defined(__x86_64__)
+    &ComplexKernels::avx512Table, &ComplexKernels::avx2Table, &ComplexKernels::sse2Table,
+#endif
+    &ComplexKernels::scalarTable
+};
+
+// whether the CPU (and the operating system, which has to save the wider registers) can run a table. __builtin_cpu_init comes
+// first - this may run from another library's static constructor, before the one of libgcc which fills in what
+// __builtin_cpu_supports reads
+static bool cpuSupports(const ComplexKernels::kernelTable* table) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if(table == &ComplexKernels::avx512Table) return __builtin_cpu_supports("avx512f");
+    if(table == &ComplexKernels::avx2Table) return __builtin_cpu_supports("avx2");
+    if(table == &ComplexKernels::sse2Table) return __builtin_cpu_supports("sse2");
+#endif
+    return table == &ComplexKernels::scalarTable;
+}
+
+static const ComplexKernels::kernelTable* findKernels(const char* name) {
+    for(const auto* table : allKernels) {
+        if(std::strcmp(table->name, name) == 0 && cpuSupports(table)) return table;
+    }
+    return nullptr;
+}
+
+// the kernels named by the environment variable COMPLEX_KERNELS if the CPU can run them, otherwise the widest ones it can
+static const ComplexKernels::kernelTable* selectKernels() {
+    if(const char* forced = std::getenv("COMPLEX_KERNELS")) {
+        if(const auto* table = findKernels(forced)) return table;
+    }
+    for(const auto* table : allKernels) {
+        if(cpuSupports(table)) return table;
+    }
+    return &ComplexKernels::scalarTable;
+}
+
+// null until the first array operation (or useKernels) picks the kernels. the pointer is constant-initialised, so an operation
+// called from a static constructor - of this library or any other, in any order - still finds a valid table. the tables are
+// constants, so relaxed loads are enough, and useKernels can switch while other threads run array operations
+static std::atomic<const ComplexKernels::kernelTable*> activeKernels{nullptr};
+
+static const ComplexKernels::kernelTable& kernels() {
+    const ComplexKernels::kernelTable* table = activeKernels.load(std::memory_order_relaxed);
+    if(!table) {
+        // threads racing here all select the same table - and a concurrent useKernels wins over the default
+        const ComplexKernels::kernelTable* selected = selectKernels();
+        table = activeKernels.compare_exchange_strong(table, selected, std::memory_order_relaxed) ? selected : table;
+    }
+    return *table;
+}
+
+static void prepareOutput(std::size_t n, ComplexArray &out) {
+    if(out.size() != n) out = ComplexArray(n);
+}
+
+static void checkSizes(const ComplexArray &a, const ComplexArray &b) {
+    if(a.size() != b.size()) throw std::invalid_argument("ComplexArray operands have different sizes");
+}
 
-void ComplexShared::print() {
-    std::cout << "Number is: " << re << (im >=0 ? " + " : " - ") << abs(im) << "i" << std::endl;
+void SharedLib::add(const ComplexArray &a, const ComplexArray &b, ComplexArray &out) {
+    checkSizes(a, b);
+    prepareOutput(a.size(), out);
+    kernels().add(a.real(), a.imag(), b.real(), b.imag(), out.real(), out.imag(), a.size());
 }
 
-ComplexShared ComplexShared::operator+(ComplexShared &other) {
-    ComplexShared sum;
-    sum.re = this->re + other.re;
-    sum.im = this->im + other.im;
-    return sum;
+void SharedLib::sub(const ComplexArray &a, const ComplexArray &b, ComplexArray &out) {
+    checkSizes(a, b);
+    prepareOutput(a.size(), out);
+    kernels().sub(a.real(), a.imag(), b.real(), b.imag(), out.real(), out.imag(), a.size());
 }
 
-ComplexShared ComplexShared::operator-(ComplexShared &other) {
-    ComplexShared diff;
-    diff.re = this->re - other.re;
-    diff.im = this->im - other.im;
-    return diff;
+void SharedLib::mul(const ComplexArray &a, const ComplexArray &b, ComplexArray &out) {
+    checkSizes(a, b);
+    prepareOutput(a.size(), out);
+    kernels().mul(a.real(), a.imag(), b.real(), b.imag(), out.real(), out.imag(), a.size());
 }
 
-ComplexShared ComplexShared::operator*(ComplexShared &other) {
-    ComplexShared prod;
-    double a = this->re, b = this->im, c = other.re, d = other.im;
-    prod.re = a*c - b*d;
-    prod.im = a*d + b*c;
-    return prod;
+void SharedLib::div(const ComplexArray &a, const ComplexArray &b, ComplexArray &out, DivisionMode mode) {
+    checkSizes(a, b);
+    prepareOutput(a.size(), out);
+    auto kernel = mode == DivisionMode::reciprocal ? kernels().divReciprocal : kernels().div;
+    kernel(a.real(), a.imag(), b.real(), b.imag(), out.real(), out.imag(), a.size());
 }
 
-ComplexShared ComplexShared::operator/(ComplexShared &other) {
-    ComplexShared div;
-    if(other.re == 0 && other.im == 0) return div;
+void SharedLib::conjugate(const ComplexArray &a, ComplexArray &out) {
+    prepareOutput(a.size(), out);
+    kernels().conjugate(a.real(), a.imag(), out.real(), out.imag(), a.size());
+}
+
+void SharedLib::magnitude(const ComplexArray &a, std::vector<double> &out) {
+    out.resize(a.size());
+    kernels().magnitude(a.real(), a.imag(), out.data(), a.size());
+}
+
+void SharedLib::scale(const ComplexArray &a, double factor, ComplexArray &out) {
+    prepareOutput(a.size(), out);
+    kernels().scale(a.real(), a.imag(), factor, out.real(), out.imag(), a.size());
+}
 
-    double a = this->re, b = this->im, c = other.re, d = other.im;
-    div.re = (a*c + b*d) / (c*c + d*d);
-    div.im = (b*c - a*d) / (c*c + d*d);
-    return div;
-}
\ No newline at end of file
+const char* SharedLib::arrayKernels() {
+    return kernels().name;
+}
+
+std::vector<const char*> SharedLib::availableKernels() {
+    std::vector<const char*> names;
+    for(const auto* table : allKernels) {
+        if(cpuSupports(table)) names.push_back(table->name);
+    }
+    return names;
+}
+
+bool SharedLib::useKernels(const char* name) {
+    const auto* table = findKernels(name);
+    if(!table) return false;
+    activeKernels.store(table, std::memory_order_relaxed);
+    return true;
+}
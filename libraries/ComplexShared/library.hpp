@@ -1,20 +1,68 @@
 #ifndef COMPLEXSHARED_LIBRARY_HPP
 #define COMPLEXSHARED_LIBRARY_HPP
 
+#include "../ComplexHeader/complex.hpp"
+#include <cstddef>
+#include <vector>
+
 namespace SharedLib {
     void printMessage();
 }
 
-class ComplexShared {
+// the arithmetic is header-only (ComplexHeader/complex.hpp), so that it can be inlined into the loops of the application
+using ComplexShared = Complex<double>;
+
+// an array of complex numbers in structure-of-arrays layout - all the real parts in one array and all the imaginary parts in another,
+// so that the operations below can process 4 (AVX2) or 8 (AVX-512) samples per instruction
+class ComplexArray {
 public:
-    double re, im;
-    ComplexShared();
-    ComplexShared(double r, double i);
-    void print();
-    ComplexShared operator+(ComplexShared& other);
-    ComplexShared operator-(ComplexShared& other);
-    ComplexShared operator*(ComplexShared& other);
-    ComplexShared operator/(ComplexShared& other);
+    ComplexArray();
+    explicit ComplexArray(std::size_t n);
+    ComplexArray(const ComplexArray& other);
+    ComplexArray(ComplexArray&& other) noexcept;
+    ComplexArray& operator=(ComplexArray other) noexcept;
+    ~ComplexArray();
+
+    std::size_t size() const { return n; }
+    double* real() { return re; }
+    double* imag() { return im; }
+    const double* real() const { return re; }
+    const double* imag() const { return im; }
+
+    ComplexShared get(std::size_t i) const { return ComplexShared(re[i], im[i]); }
+    void set(std::size_t i, const ComplexShared& value) { re[i] = value.re; im[i] = value.im; }
+
+private:
+    double* re;
+    double* im;
+    std::size_t n;
 };
 
+// elementwise operations on whole arrays - 'out' is resized to the size of the inputs and may be one of them (in-place), two inputs
+// of different sizes throw std::invalid_argument. division uses smith's algorithm and the special values of C99 Annex G, like
+// operator/ - 'reciprocal' multiplies by the inverse of the denominator instead of dividing by it twice, which is faster and may
+// be off by one more unit in the last place
+namespace SharedLib {
+    enum class DivisionMode { smith, reciprocal };
+
+    void add(const ComplexArray& a, const ComplexArray& b, ComplexArray& out);
+    void sub(const ComplexArray& a, const ComplexArray& b, ComplexArray& out);
+    void mul(const ComplexArray& a, const ComplexArray& b, ComplexArray& out);
+    void div(const ComplexArray& a, const ComplexArray& b, ComplexArray& out, DivisionMode mode = DivisionMode::smith);
+    void conjugate(const ComplexArray& a, ComplexArray& out);
+    void magnitude(const ComplexArray& a, std::vector<double>& out);
+    void scale(const ComplexArray& a, double factor, ComplexArray& out);
+
+    // the array operations are compiled for several instruction sets, and the library picks one set of kernels on first use: the
+    // widest the CPU supports, unless the environment variable COMPLEX_KERNELS names another one it supports. every set gives
+    // bitwise identical results, except the reciprocal division, whose last bits may differ between sets
+
+    // the kernels in use - "avx512", "avx2", "sse2" or "scalar"
+    const char* arrayKernels();
+    // the kernels this CPU can run, widest first
+    std::vector<const char*> availableKernels();
+    // switches to the named kernels - false, and no change, if the name is unknown or the CPU cannot run them
+    bool useKernels(const char* name);
+}
+
 #endif //COMPLEXSHARED_LIBRARY_HPP
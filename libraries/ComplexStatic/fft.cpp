@@ -0,0 +1,181 @@
+#include "fft.hpp"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+
+namespace {
+
+// the butterflies use ComplexStatic's own operators - they are header-only and take const references (ComplexHeader/complex.hpp),
+// so the compiler inlines them into the inner loops
+inline ComplexStatic conj(const ComplexStatic& a) { return ComplexStatic(a.re, -a.im); }
+
+// multiplies by -i (forward) or +i (inverse) - the twiddle of the second half of a radix-4 butterfly, without a multiplication
+inline ComplexStatic rotate(const ComplexStatic& a, bool forward) {
+    return forward ? ComplexStatic(a.im, -a.re) : ComplexStatic(-a.im, a.re);
+}
+
+inline ComplexStatic polar(double angle) { return ComplexStatic(std::cos(angle), std::sin(angle)); }
+
+// puts the samples in bit-reversed order, which turns the in-order output of the decimation in time passes into natural order
+void bitReverse(ComplexStatic* data, std::size_t n) {
+    for(std::size_t i = 1, j = 0; i < n; i++) {
+        std::size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if(i < j) std::swap(data[i], data[j]);
+    }
+}
+
+void bitReverseCopy(const ComplexStatic* in, ComplexStatic* out, std::size_t n) {
+    out[0] = in[0];
+    for(std::size_t i = 1, j = 0; i < n; i++) {
+        std::size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        out[j] = in[i];
+    }
+}
+
+}
+
+StaticLib::FFTPlan::FFTPlan(std::size_t n, Direction direction)
+    : n{n}, dir{direction}, powerOfTwo{n != 0 && (n & (n - 1)) == 0} {
+    if(n == 0) throw std::invalid_argument("FFTPlan needs at least one sample");
+    const double sign = dir == Direction::forward ? -1.0 : 1.0;
+    const double pi = std::acos(-1.0);
+
+    if(powerOfTwo) {
+        // twiddles[m + j] = exp(-+ pi i j / m) for the pass which combines blocks of size m, so that every pass reads its twiddles
+        // contiguously (a single table of exp(-2 pi i k / N) would be read with a stride in the early passes)
+        twiddles.resize(std::max<std::size_t>(n, 2));
+        for(std::size_t m = 1; m < n; m *= 2) {
+            for(std::size_t j = 0; j < m; j++) twiddles[m + j] = polar(sign * pi * double(j) / double(m));
+        }
+        return;
+    }
+
+    // bluestein: jk = (j^2 + k^2 - (k - j)^2) / 2, so the transform is the chirp times the convolution of (x * chirp) with the
+    // conjugate chirp. k^2 is reduced mod 2N before the conversion to double, which keeps the angle exact for large k
+    std::size_t m = 1;
+    while(m < 2 * n - 1) m *= 2;
+    inner.reset(new FFTPlan(m, Direction::forward));
+
+    chirp.resize(n);
+    for(std::size_t k = 0; k < n; k++) {
+        unsigned long long k2 = (unsigned long long)k * k % (2 * n);
+        chirp[k] = polar(sign * pi * double(k2) / double(n));
+    }
+
+    kernelSpectrum.assign(m, ComplexStatic(0, 0));
+    for(std::size_t k = 0; k < n; k++) {
+        ComplexStatic c = conj(chirp[k]);
+        kernelSpectrum[k] = c;
+        if(k) kernelSpectrum[m - k] = c;
+    }
+    inner->execute(kernelSpectrum.data());
+}
+
+StaticLib::FFTPlan::~FFTPlan() = default;
+
+const char* StaticLib::FFTPlan::algorithm() const {
+    if(!powerOfTwo) return "bluestein";
+    return n >= 4 ? "radix-4" : "radix-2";
+}
+
+// decimation in time on bit-reversed data. each radix-4 pass fuses the radix-2 passes of half-size m and 2m:
+//   a0, a1 = x0 +- w1 x1       a2, a3 = x2 +- w1 x3        (w1 = twiddle j of pass m)
+//   y0, y2 = a0 +- w2 a2       y1, y3 = a1 +- (-+i) w2 a3  (w2 = twiddle j of pass 2m, and twiddle j + m = w2 * -+i)
+// so the data is read and written once per two passes
+void StaticLib::FFTPlan::executePowerOfTwo(ComplexStatic* data) const {
+    const bool forward = dir == Direction::forward;
+    std::size_t m = 1;
+    for(; 4 * m <= n; m *= 4) {
+        const ComplexStatic* w1 = &twiddles[m];
+        const ComplexStatic* w2 = &twiddles[2 * m];
+        for(std::size_t k = 0; k < n; k += 4 * m) {
+            ComplexStatic* block = data + k;
+            for(std::size_t j = 0; j < m; j++) {
+                ComplexStatic t1 = w1[j], t2 = w2[j];
+                ComplexStatic x0 = block[j], x1 = block[j + m], x2 = block[j + 2 * m], x3 = block[j + 3 * m];
+                ComplexStatic p = t1 * x1, q = t1 * x3;
+                ComplexStatic a0 = x0 + p, a1 = x0 - p, a2 = x2 + q, a3 = x2 - q;
+                ComplexStatic u = t2 * a2, v = rotate(t2 * a3, forward);
+                block[j] = a0 + u;
+                block[j + 2 * m] = a0 - u;
+                block[j + m] = a1 + v;
+                block[j + 3 * m] = a1 - v;
+            }
+        }
+    }
+    // odd log2(N) - one radix-2 pass is left
+    if(2 * m == n) {
+        const ComplexStatic* w = &twiddles[m];
+        for(std::size_t j = 0; j < m; j++) {
+            ComplexStatic x0 = data[j], x1 = w[j] * data[j + m];
+            data[j] = x0 + x1;
+            data[j + m] = x0 - x1;
+        }
+    }
+}
+
+// the convolution with the kernel is done in the frequency domain: forward transform, multiply, inverse transform. the inverse is
+// the forward plan on conjugated data (ifft(x) = conj(fft(conj(x))) / M), so only one inner plan is needed
+void StaticLib::FFTPlan::executeBluestein(const ComplexStatic* in, ComplexStatic* out, ComplexStatic* scratch) const {
+    const std::size_t m = inner->size();
+    for(std::size_t k = 0; k < n; k++) scratch[k] = in[k] * chirp[k];
+    std::fill(scratch + n, scratch + m, ComplexStatic(0, 0));
+    inner->execute(scratch);
+    for(std::size_t k = 0; k < m; k++) scratch[k] = conj(scratch[k] * kernelSpectrum[k]);
+    inner->execute(scratch);
+    const double scale = 1.0 / double(m);
+    for(std::size_t k = 0; k < n; k++) {
+        ComplexStatic y = conj(scratch[k]);
+        out[k] = chirp[k] * ComplexStatic(y.re * scale, y.im * scale);
+    }
+}
+
+// 'scratch' is only used by bluestein - passed in so that a batch allocates it once per thread, not once per transform
+void StaticLib::FFTPlan::executeWith(const ComplexStatic* in, ComplexStatic* out, std::vector<ComplexStatic>& scratch) const {
+    if(powerOfTwo) {
+        if(in == out) bitReverse(out, n);
+        else bitReverseCopy(in, out, n);
+        executePowerOfTwo(out);
+    } else {
+        scratch.resize(inner->size());
+        executeBluestein(in, out, scratch.data());
+    }
+    if(dir == Direction::inverse) {
+        const double scale = 1.0 / double(n);
+        for(std::size_t k = 0; k < n; k++) {
+            out[k].re *= scale;
+            out[k].im *= scale;
+        }
+    }
+}
+
+void StaticLib::FFTPlan::execute(const ComplexStatic* in, ComplexStatic* out) const {
+    std::vector<ComplexStatic> scratch;
+    executeWith(in, out, scratch);
+}
+
+void StaticLib::FFTPlan::execute(ComplexStatic* data) const {
+    execute(data, data);
+}
+
+void StaticLib::FFTPlan::executeBatch(const ComplexStatic* in, ComplexStatic* out, std::size_t count, unsigned threads) const {
+    threads = unsigned(std::max<std::size_t>(1, std::min<std::size_t>(threads, count)));
+    auto worker = [this, in, out, count, threads](unsigned t) {
+        std::vector<ComplexStatic> scratch;
+        std::size_t first = count * t / threads, last = count * (t + 1) / threads;
+        for(std::size_t b = first; b < last; b++) executeWith(in + b * n, out + b * n, scratch);
+    };
+    if(threads == 1) {
+        worker(0);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for(unsigned t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for(auto& th : pool) th.join();
+}
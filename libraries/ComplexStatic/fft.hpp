@@ -0,0 +1,66 @@
+#ifndef COMPLEXSTATIC_FFT_HPP
+#define COMPLEXSTATIC_FFT_HPP
+
+#include "library.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace StaticLib {
+
+// a precomputed fast Fourier transform of one size and direction - replaces the O(N^2) DFT loops over ComplexStatic samples with
+// O(N log N) transforms:
+// - N a power of two: iterative decimation in time, two radix-2 stages fused into one radix-4 pass over the data (plus a single
+//   radix-2 pass when log2(N) is odd). the twiddle factors of every pass are computed once, in the plan, in the order they are used
+// - any other N: Bluestein's algorithm, which rewrites the transform as a convolution and evaluates that with power-of-two
+//   transforms of size M >= 2N - 1 (the chirp and the transformed convolution kernel are part of the plan too)
+// the forward transform is X[k] = sum x[j] * exp(-2 pi i jk / N); the inverse uses the opposite sign and divides by N, so that
+// inverse(forward(x)) == x
+// a plan is immutable once built, so one plan can be used by any number of threads at the same time
+class FFTPlan {
+public:
+    enum class Direction { forward, inverse };
+
+    explicit FFTPlan(std::size_t n, Direction direction = Direction::forward);
+    ~FFTPlan();
+
+    FFTPlan(const FFTPlan&) = delete;
+    FFTPlan& operator=(const FFTPlan&) = delete;
+
+    std::size_t size() const { return n; }
+    Direction direction() const { return dir; }
+
+    // "radix-4", "radix-2" (N = 1 or 2) or "bluestein"
+    const char* algorithm() const;
+
+    // out-of-place - 'in' and 'out' hold size() samples each and must not overlap
+    void execute(const ComplexStatic* in, ComplexStatic* out) const;
+
+    // in-place - 'data' holds size() samples
+    void execute(ComplexStatic* data) const;
+
+    // 'count' independent transforms stored back to back (in[t * size() + j]), spread over 'threads' threads. in == out runs them
+    // in place
+    void executeBatch(const ComplexStatic* in, ComplexStatic* out, std::size_t count, unsigned threads = 1) const;
+
+private:
+    std::size_t n;
+    Direction dir;
+    bool powerOfTwo;
+
+    // power of two - the twiddles of the pass with half-size m are twiddles[m .. 2m)
+    std::vector<ComplexStatic> twiddles;
+
+    // bluestein - the chirp exp(-+ pi i k^2 / N), the forward transform of the convolution kernel, and the size-M plan
+    std::vector<ComplexStatic> chirp;
+    std::vector<ComplexStatic> kernelSpectrum;
+    std::unique_ptr<FFTPlan> inner;
+
+    void executePowerOfTwo(ComplexStatic* data) const;
+    void executeBluestein(const ComplexStatic* in, ComplexStatic* out, ComplexStatic* scratch) const;
+    void executeWith(const ComplexStatic* in, ComplexStatic* out, std::vector<ComplexStatic>& scratch) const;
+};
+
+}
+
+#endif //COMPLEXSTATIC_FFT_HPP
@@ -0,0 +1,113 @@
+// FFT checks and GFLOPS benchmark for the plans in fft.hpp
+#include "fft.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
+
+// build with the CMake target FFTBench, or by hand:
+//     g++ -std=c++17 -O2 -march=native -pthread fftbench.cpp fft.cpp library.cpp -o fftbench
+// run with: ./fftbench [max log2 size] [threads]
+
+// the O(N^2) loop the FFT replaces, written with the ComplexStatic operators - the reference for the checks
+std::vector<ComplexStatic> naiveDFT(std::vector<ComplexStatic>& x) {
+    const double pi = std::acos(-1.0);
+    std::size_t n = x.size();
+    std::vector<ComplexStatic> out(n);
+    for(std::size_t k = 0; k < n; k++) {
+        ComplexStatic sum;
+        for(std::size_t j = 0; j < n; j++) {
+            double angle = -2 * pi * double(j * k % n) / double(n);
+            ComplexStatic w(std::cos(angle), std::sin(angle));
+            ComplexStatic term = x[j] * w;
+            sum = sum + term;
+        }
+        out[k] = sum;
+    }
+    return out;
+}
+
+std::vector<ComplexStatic> randomSignal(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<ComplexStatic> x(n);
+    for(auto& c : x) c = ComplexStatic(dist(rng), dist(rng));
+    return x;
+}
+
+double maxDifference(const std::vector<ComplexStatic>& a, const std::vector<ComplexStatic>& b) {
+    double diff = 0;
+    for(std::size_t i = 0; i < a.size(); i++) diff = std::max(diff, std::abs(a[i].re - b[i].re) + std::abs(a[i].im - b[i].im));
+    return diff;
+}
+
+// against the naive DFT (out-of-place and in-place), and a round trip through the inverse plan
+bool check(std::size_t n) {
+    std::vector<ComplexStatic> x = randomSignal(n, unsigned(n));
+    std::vector<ComplexStatic> expected = naiveDFT(x), out(n), back(n);
+    StaticLib::FFTPlan forward(n), inverse(n, StaticLib::FFTPlan::Direction::inverse);
+    forward.execute(x.data(), out.data());
+    double error = maxDifference(out, expected);
+    std::vector<ComplexStatic> inPlace = x;
+    forward.execute(inPlace.data());
+    error = std::max(error, maxDifference(inPlace, expected));
+    inverse.execute(out.data(), back.data());
+    double roundTrip = maxDifference(back, x);
+    bool ok = error < 1e-9 * double(n) && roundTrip < 1e-12 * double(n);
+    std::cout << "  N = " << n << " (" << forward.algorithm() << "): max error " << error << ", round trip " << roundTrip
+              << (ok ? "" : "  FAILED") << std::endl;
+    return ok;
+}
+
+// 5 N log2(N) floating point operations per transform, the usual convention for comparing FFTs (also used for bluestein sizes)
+double gflops(std::size_t n, double seconds, std::size_t transforms) {
+    return 5.0 * double(n) * std::log2(double(n)) * double(transforms) / seconds / 1e9;
+}
+
+double timeTransforms(const StaticLib::FFTPlan& plan, std::vector<ComplexStatic>& data, std::size_t count, unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    plan.executeBatch(data.data(), data.data(), count, threads);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    int maxLog = argc > 1 ? std::atoi(argv[1]) : 24;
+    unsigned threads = argc > 2 ? unsigned(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+    bool ok = true;
+    std::cout << "checks against the O(N^2) DFT:" << std::endl;
+    for(std::size_t n : {1, 2, 4, 8, 32, 64, 128, 512, 3, 5, 12, 100, 127, 1000}) ok = check(n) && ok;
+
+    // every size gets roughly the same amount of work (2^26 samples), spread over repeated in-place transforms
+    std::cout << "log2 N   single thread GFLOPS   batched on " << threads << " threads GFLOPS" << std::endl;
+    for(int logN = 6; logN <= maxLog; logN++) {
+        std::size_t n = std::size_t(1) << logN;
+        std::size_t count = std::max<std::size_t>(1, (std::size_t(1) << 26) / n / 4);
+        StaticLib::FFTPlan plan(n);
+        std::vector<ComplexStatic> data = randomSignal(n * std::min<std::size_t>(count, 64), 1);
+        std::size_t batch = data.size() / n;
+
+        std::size_t rounds = (count + batch - 1) / batch;
+        double single = 0, batched = 0;
+        for(std::size_t r = 0; r < rounds; r++) single += timeTransforms(plan, data, batch, 1);
+        for(std::size_t r = 0; r < rounds; r++) batched += timeTransforms(plan, data, batch, threads);
+        std::cout << logN << "\t " << gflops(n, single, rounds * batch) << "\t\t\t" << gflops(n, batched, rounds * batch) << std::endl;
+    }
+
+    // sizes which are not a power of two go through bluestein, at a few times the cost of the next power of two
+    for(std::size_t n : {1000, 10007, 1000000}) {
+        StaticLib::FFTPlan plan(n);
+        std::vector<ComplexStatic> data = randomSignal(n, 2);
+        std::size_t count = std::max<std::size_t>(1, (std::size_t(1) << 24) / n);
+        double seconds = 0;
+        for(std::size_t r = 0; r < count; r++) seconds += timeTransforms(plan, data, 1, 1);
+        std::cout << "N = " << n << " (" << plan.algorithm() << "): " << gflops(n, seconds, count) << " GFLOPS" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
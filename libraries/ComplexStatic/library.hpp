@@ -1,20 +1,13 @@
 #ifndef COMPLEXSTATIC_LIBRARY_HPP
 #define COMPLEXSTATIC_LIBRARY_HPP
 
+#include "../ComplexHeader/complex.hpp"
+
 namespace StaticLib {
 void printMessage();
 }
 
-class ComplexStatic {
-public:
-    double re, im;
-    ComplexStatic();
-    ComplexStatic(double r, double i);
-    void print();
-    ComplexStatic operator+(ComplexStatic& other);
-    ComplexStatic operator-(ComplexStatic& other);
-    ComplexStatic operator*(ComplexStatic& other);
-    ComplexStatic operator/(ComplexStatic& other);
-};
+// the arithmetic is header-only (ComplexHeader/complex.hpp), so that it can be inlined into the loops of the application
+using ComplexStatic = Complex<double>;
 
 #endif //COMPLEXSTATIC_LIBRARY_HPP
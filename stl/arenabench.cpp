@@ -0,0 +1,79 @@
+// benchmark for the arena in arenaresource.hpp - per-request temporary containers on the arena against the default heap
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include "arenaresource.hpp"
+
+// compile with: g++ -std=c++17 -O2 arenabench.cpp -o arenabench
+// run with:     ./arenabench [requests]
+
+// a synthetic request - parses a few dozen 'headers' into a map, collects numbers into a vector, and builds a response string. the
+// same kinds of temporaries as the stl/ demos (vector, map, string), all freed when the request ends. the strings are longer than the
+// small string buffer, so they allocate too
+long handleRequest(long id, std::pmr::memory_resource* resource) {
+    std::pmr::map<std::pmr::string, std::pmr::string> headers(resource);
+    std::pmr::vector<long> numbers(resource);
+    std::pmr::string response(resource);
+
+    int numHeaders = 16 + int(id % 32);
+    for(int h=0; h<numHeaders; h++) {
+        std::pmr::string key("x-request-header-number-", resource);
+        key += std::to_string(h);
+        std::pmr::string value("some reasonably long header value for request ", resource);
+        value += std::to_string(id);
+        headers.emplace(std::move(key), std::move(value));
+    }
+    for(long i=0; i<64 + id % 192; i++) numbers.push_back(i * id);
+
+    for(const auto& header : headers) {
+        response += header.first;
+        response += ": ";
+        response += header.second;
+        response += "\n";
+    }
+    long sum = 0;
+    for(long n : numbers) sum += n;
+    return sum + long(response.size());
+}
+
+int main(int argc, char* argv[]) {
+    long requests = argc > 1 ? std::atol(argv[1]) : 200000;
+
+    // scopes nest - the inner scope drops only its own allocations
+    ArenaResource arena;
+    {
+        ArenaScope outer(arena);
+        std::pmr::vector<int> kept({1, 2, 3}, &arena);
+        {
+            ArenaScope inner(arena);
+            std::pmr::string temporary("a temporary string, long enough to be allocated from the arena", &arena);
+        }
+        kept.push_back(4);
+        std::cout << "kept after the inner scope: " << kept.size() << " elements, arena capacity " << arena.capacity() << " bytes"
+                  << std::endl;
+    }
+
+    // default heap - every buffer, node and long string is a malloc and a free
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(long r=0; r<requests; r++) sum += handleRequest(r, std::pmr::new_delete_resource());
+    std::chrono::duration<double, std::nano> heapTime = std::chrono::steady_clock::now() - start;
+
+    // arena - one scope per request, the blocks are reused from one request to the next
+    start = std::chrono::steady_clock::now();
+    for(long r=0; r<requests; r++) {
+        ArenaScope scope(arena);
+        sum -= handleRequest(r, &arena);
+    }
+    std::chrono::duration<double, std::nano> arenaTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "heap  : " << heapTime.count() / requests << " ns per request" << std::endl;
+    std::cout << "arena : " << arenaTime.count() / requests << " ns per request (capacity " << arena.capacity() << " bytes)" << std::endl;
+
+    // the two runs computed the same results, so the sums cancel out
+    return sum == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// header file for a monotonic arena memory resource, with an RAII scope which resets it (for per-request temporary containers)
+#ifndef ARENARESOURCE_HPP
+#define ARENARESOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// a request handler builds temporary vectors, maps and strings, and frees all of them when the request is done. with the default heap
+// every element buffer, node and string is its own malloc and free. an arena turns that into:
+// - allocate: bump a cursor inside the current block (and move to the next block of the chain when the current one is full)
+// - deallocate: nothing at all - memory is only given back in bulk
+// - reset: put the cursor back to where it was at the start of the request - O(1), whatever was allocated in between
+// the blocks are kept in a chain and reused by the next request, so after warm up the arena does not touch the heap any more
+// std::pmr::monotonic_buffer_resource does the bump allocation too, but release() frees its blocks and there is no way to rewind it to
+// an earlier point, which is what a scope needs
+// the arena derives from std::pmr::memory_resource, so the std::pmr containers (std::pmr::vector, std::pmr::map, std::pmr::string)
+// use it directly, and it is not thread safe - one arena per thread or per request
+class ArenaResource : public std::pmr::memory_resource {
+    private:
+        struct block {
+            block* next;
+            std::size_t size;       // usable bytes after the header
+
+            char* begin() { return reinterpret_cast<char*>(this + 1); }
+            char* end() { return begin() + size; }
+        };
+
+        std::pmr::memory_resource* upstream;
+        std::size_t nextBlockSize;
+        block* first = nullptr;
+        block* current = nullptr;
+        char* cursor = nullptr;
+
+        static constexpr std::size_t maxBlockSize = 1 << 20;
+
+        block* newBlock(std::size_t minSize) {
+            std::size_t size = nextBlockSize < minSize ? minSize : nextBlockSize;
+            if(nextBlockSize < maxBlockSize) nextBlockSize *= 2;
+            block* blk = static_cast<block*>(upstream->allocate(sizeof(block) + size, alignof(std::max_align_t)));
+            blk->next = nullptr;
+            blk->size = size;
+            return blk;
+        }
+
+        static char* alignUp(char* ptr, std::size_t alignment) {
+            std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+            return reinterpret_cast<char*>((addr + alignment - 1) & ~std::uintptr_t(alignment - 1));
+        }
+
+    protected:
+        // the slow path moves on to the next block of the chain, reusing blocks from earlier requests. a block which is too small for
+        // this request is skipped (it stays in the chain for later), and if none fits, a new block is linked in after the current one
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if(current) {
+                char* ptr = alignUp(cursor, alignment);
+                if(ptr + bytes <= current->end()) {
+                    cursor = ptr + bytes;
+                    return ptr;
+                }
+            }
+            std::size_t needed = bytes + alignment;
+            block* blk = current ? current->next : first;
+            while(blk && blk->size < needed) blk = blk->next;
+            if(!blk) {
+                blk = newBlock(needed);
+                if(!current) {
+                    blk->next = first;
+                    first = blk;
+                } else {
+                    blk->next = current->next;
+                    current->next = blk;
+                }
+            }
+            current = blk;
+            char* ptr = alignUp(blk->begin(), alignment);
+            cursor = ptr + bytes;
+            return ptr;
+        }
+
+        // individual deallocations are ignored - the memory comes back with reset() or rewind()
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    public:
+        // a position in the arena - everything allocated after it can be dropped at once with rewind()
+        struct marker {
+            block* blk;
+            char* cursor;
+        };
+
+        explicit ArenaResource(std::size_t initialBlockSize = 64 * 1024,
+                               std::pmr::memory_resource* upstreamResource = std::pmr::get_default_resource())
+            : upstream(upstreamResource), nextBlockSize(initialBlockSize) {}
+
+        // the arena owns its blocks, so it can be neither copied nor moved (the containers using it hold a pointer to it)
+        ArenaResource(const ArenaResource&) = delete;
+        ArenaResource& operator=(const ArenaResource&) = delete;
+
+        ~ArenaResource() { release(); }
+
+        marker mark() const { return marker{current, cursor}; }
+
+        // O(1) - the blocks after the marked one stay in the chain, and the next allocations reuse them
+        void rewind(marker m) {
+            current = m.blk;
+            cursor = m.cursor;
+        }
+
+        void reset() { rewind(marker{nullptr, nullptr}); }
+
+        // gives all the blocks back to the upstream resource
+        void release() {
+            while(first) {
+                block* next = first->next;
+                upstream->deallocate(first, sizeof(block) + first->size, alignof(std::max_align_t));
+                first = next;
+            }
+            current = nullptr;
+            cursor = nullptr;
+        }
+
+        // bytes reserved from upstream, over all the blocks of the chain
+        std::size_t capacity() const {
+            std::size_t total = 0;
+            for(block* blk = first; blk; blk = blk->next) total += blk->size;
+            return total;
+        }
+};
+
+// RAII scope over an arena, in the same spirit as the Collection class in advconcepts/raii.cpp - the constructor marks the current
+// position and the destructor rewinds to it, so everything allocated from the arena inside the scope is dropped when the scope ends,
+// however it ends (return, exception). scopes nest: an inner scope only drops what was allocated inside it
+// every container that used the arena inside the scope has to be destroyed before the scope itself - declare the scope first
+class ArenaScope {
+    private:
+        ArenaResource& arena;
+        ArenaResource::marker saved;
+
+    public:
+        explicit ArenaScope(ArenaResource& a) : arena(a), saved(a.mark()) {}
+        ~ArenaScope() { arena.rewind(saved); }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+#endif
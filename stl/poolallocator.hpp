@@ -0,0 +1,226 @@
+// header file for a thread-caching small-object pool allocator, for the nodes of list, forward_list, map and set
+#ifndef POOLALLOCATOR_HPP
+#define POOLALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <mutex>
+#include <vector>
+#include <limits>
+
+// node-based containers allocate one node per element with the default allocator, i.e. one malloc and one free per insert and erase.
+// under multi-threaded churn every one of those calls goes through the general purpose allocator, which has to handle any size and
+// synchronise between threads. nodes are small and only come in a few sizes, so a pool can do much better:
+// 1. requests are rounded up to a 'size class' (a multiple of 16 bytes, up to 256), and every class keeps its own free blocks
+// 2. every thread has a cache per size class - a singly linked free list threaded through the free blocks themselves. allocating and
+//    freeing are a pop and a push on that list, with no lock and no atomic
+// 3. when a thread cache runs dry it takes a whole batch of blocks from the central depot, and when it holds too many it gives a batch
+//    back - so the depot lock is taken once per batch, not once per node. the depot carves new blocks out of 64KB slabs
+// a block freed by a different thread than the one which allocated it simply joins the freeing thread's cache, so containers can be
+// built on one thread and destroyed on another. a thread whose cache is already destroyed (another thread_local's destructor still
+// freeing nodes at thread exit) goes to the depot one block at a time
+
+namespace poolDetail {
+    constexpr std::size_t granularity = 16;
+    constexpr std::size_t maxBlockSize = 256;
+    constexpr std::size_t numClasses = maxBlockSize / granularity;
+    constexpr std::size_t batchSize = 64;
+    constexpr std::size_t slabSize = 64 * 1024;
+
+    constexpr std::size_t classOf(std::size_t bytes) { return (bytes + granularity - 1) / granularity - 1; }
+    constexpr std::size_t blockSizeOf(std::size_t sizeClass) { return (sizeClass + 1) * granularity; }
+
+    struct freeBlock {
+        freeBlock* next;
+    };
+
+    // a batch is a chain of blocks linked through freeBlock::next (normally 'batchSize' of them, fewer when a thread exits) - moved
+    // between a thread cache and the depot as a whole
+    struct batch {
+        freeBlock* head;
+        std::size_t count;
+    };
+
+    // the central depot - full batches per size class, plus the slabs they were carved from. slabs are never given back, a pool keeps
+    // the peak of what the program used (the usual trade-off of pool allocators)
+    class depot {
+        private:
+            std::mutex lock;
+            std::vector<batch> batches[numClasses];
+            std::vector<void*> slabs;
+            char* slabCursor = nullptr;
+            char* slabEnd = nullptr;
+
+            // carves one new batch out of a slab, starting a new slab when the current one is used up
+            batch carve(std::size_t sizeClass) {
+                std::size_t blockSize = blockSizeOf(sizeClass);
+                if(std::size_t(slabEnd - slabCursor) < batchSize * blockSize) {
+                    slabCursor = static_cast<char*>(::operator new(slabSize));
+                    slabEnd = slabCursor + slabSize;
+                    slabs.push_back(slabCursor);
+                }
+                batch fresh{reinterpret_cast<freeBlock*>(slabCursor), batchSize};
+                for(std::size_t i=0; i<batchSize; i++) {
+                    freeBlock* block = reinterpret_cast<freeBlock*>(slabCursor + i * blockSize);
+                    block->next = i + 1 < batchSize ? reinterpret_cast<freeBlock*>(slabCursor + (i + 1) * blockSize) : nullptr;
+                }
+                slabCursor += batchSize * blockSize;
+                return fresh;
+            }
+
+        public:
+            // never destroyed - a container with static storage duration can be constructed before the depot and so destroyed after
+            // it, and its nodes still live in the slabs. the operating system takes the slabs back at exit
+            static depot& global() {
+                static depot& instance = *new depot;
+                return instance;
+            }
+
+            batch take(std::size_t sizeClass) {
+                std::lock_guard<std::mutex> guard(lock);
+                if(batches[sizeClass].empty()) return carve(sizeClass);
+                batch full = batches[sizeClass].back();
+                batches[sizeClass].pop_back();
+                return full;
+            }
+
+            void give(std::size_t sizeClass, batch full) {
+                std::lock_guard<std::mutex> guard(lock);
+                batches[sizeClass].push_back(full);
+            }
+
+            // single blocks, for threads without a cache - taken from and added to the last batch of the class
+            void* takeOne(std::size_t sizeClass) {
+                std::lock_guard<std::mutex> guard(lock);
+                std::vector<batch>& list = batches[sizeClass];
+                if(list.empty()) list.push_back(carve(sizeClass));
+                batch& last = list.back();
+                freeBlock* block = last.head;
+                last.head = block->next;
+                if(--last.count == 0) list.pop_back();
+                return block;
+            }
+
+            void giveOne(std::size_t sizeClass, void* ptr) {
+                std::lock_guard<std::mutex> guard(lock);
+                std::vector<batch>& list = batches[sizeClass];
+                freeBlock* block = static_cast<freeBlock*>(ptr);
+                if(list.empty() || list.back().count >= batchSize) {
+                    block->next = nullptr;
+                    list.push_back(batch{block, 1});
+                    return;
+                }
+                block->next = list.back().head;
+                list.back().head = block;
+                list.back().count++;
+            }
+    };
+
+    // the per-thread cache - one free list per size class. a list never holds more than two batches: above that one batch goes back
+    // to the depot, so a thread which only frees (a consumer) does not hoard the blocks of a thread which only allocates (a producer)
+    class threadCache {
+        private:
+            struct freeList {
+                freeBlock* head = nullptr;
+                std::size_t count = 0;
+            };
+
+            freeList lists[numClasses];
+
+            // set by the destructor - a bool is trivially destructible, so unlike the cache it can still be read by the destructors
+            // of thread_locals which run after the cache's
+            static inline thread_local bool destroyed = false;
+
+            // hands the first 'n' blocks of the list to the depot
+            void giveBatch(std::size_t sizeClass, std::size_t n) {
+                freeList& list = lists[sizeClass];
+                freeBlock* tail = list.head;
+                for(std::size_t i=1; i<n; i++) tail = tail->next;
+                batch out{list.head, n};
+                list.head = tail->next;
+                list.count -= n;
+                tail->next = nullptr;
+                depot::global().give(sizeClass, out);
+            }
+
+        public:
+            // the cache of the calling thread, or null once it has been destroyed
+            static threadCache* local() {
+                if(destroyed) return nullptr;
+                thread_local threadCache cache;
+                return &cache;
+            }
+
+            void* allocate(std::size_t sizeClass) {
+                freeList& list = lists[sizeClass];
+                if(!list.head) {
+                    batch refill = depot::global().take(sizeClass);
+                    list.head = refill.head;
+                    list.count = refill.count;
+                }
+                freeBlock* block = list.head;
+                list.head = block->next;
+                list.count--;
+                return block;
+            }
+
+            void deallocate(void* ptr, std::size_t sizeClass) {
+                freeList& list = lists[sizeClass];
+                freeBlock* block = static_cast<freeBlock*>(ptr);
+                block->next = list.head;
+                list.head = block;
+                if(++list.count >= 2 * batchSize) giveBatch(sizeClass, batchSize);
+            }
+
+            // on thread exit every block goes back to the depot, so threads can come and go without the pool losing blocks
+            ~threadCache() {
+                destroyed = true;
+                for(std::size_t c=0; c<numClasses; c++) {
+                    if(lists[c].count) giveBatch(c, lists[c].count);
+                }
+            }
+    };
+}
+
+// the allocator itself - stateless, so all instances compare equal and a node allocated through one can be freed through any other
+// (splice between containers, a container moved to another thread). requests for more than one object or for larger objects go
+// straight to operator new, so it also works for containers which allocate arrays (the bucket array of an unordered_map)
+template<typename T>
+class PoolAllocator {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+
+        // rebinding constructor - the container is given PoolAllocator<T> but allocates its nodes through PoolAllocator<Node>
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            if(n == 1 && sizeof(T) <= poolDetail::maxBlockSize && alignof(T) <= poolDetail::granularity) {
+                std::size_t sizeClass = poolDetail::classOf(sizeof(T));
+                poolDetail::threadCache* cache = poolDetail::threadCache::local();
+                return static_cast<T*>(cache ? cache->allocate(sizeClass) : poolDetail::depot::global().takeOne(sizeClass));
+            }
+            if(n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc();
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t n) noexcept {
+            if(n == 1 && sizeof(T) <= poolDetail::maxBlockSize && alignof(T) <= poolDetail::granularity) {
+                std::size_t sizeClass = poolDetail::classOf(sizeof(T));
+                if(poolDetail::threadCache* cache = poolDetail::threadCache::local()) cache->deallocate(ptr, sizeClass);
+                else poolDetail::depot::global().giveOne(sizeClass, ptr);
+                return;
+            }
+            ::operator delete(ptr);
+        }
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept { return true; }
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept { return false; }
+
+#endif
@@ -0,0 +1,130 @@
+// benchmark for the pool allocator in poolallocator.hpp - insert/erase churn on node-based containers
+#include <iostream>
+#include <list>
+#include <forward_list>
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "poolallocator.hpp"
+
+// compile with: g++ -std=c++17 -O2 -pthread poolallocatorbench.cpp -o poolallocatorbench
+// run with:     ./poolallocatorbench [max threads] [operations per thread]
+
+// the same containers as in stllist.cpp, stlforwardlist.cpp, stlmap.cpp and stlset.cpp - the pool only has to be passed as the
+// allocator parameter, the container rebinds it to its node type
+template<template<typename> class Alloc>
+struct containers {
+    using list = std::list<int, Alloc<int>>;
+    using forwardList = std::forward_list<int, Alloc<int>>;
+    using map = std::map<int, int, std::less<int>, Alloc<std::pair<const int, int>>>;
+    using set = std::set<int, std::less<int>, Alloc<int>>;
+};
+
+// one churn step per container type - keeps the container around 'liveSize' elements, inserting one element and erasing another
+template<typename List>
+void churnList(List& l, std::mt19937& rng, int liveSize) {
+    l.push_back(int(rng()));
+    if(int(l.size()) > liveSize) {
+        auto it = l.begin();
+        std::advance(it, rng() % 8);
+        l.erase(it);
+    }
+}
+
+template<typename ForwardList>
+void churnForwardList(ForwardList& fl, std::mt19937& rng, int liveSize, int& size) {
+    fl.push_front(int(rng()));
+    if(++size > liveSize) {
+        auto it = fl.begin();
+        std::advance(it, rng() % 8);
+        if(std::next(it) != fl.end()) {
+            fl.erase_after(it);
+            size--;
+        }
+    }
+}
+
+template<typename Map>
+void churnMap(Map& m, std::mt19937& rng, int liveSize) {
+    m.emplace(int(rng() % (4 * liveSize)), 0);
+    if(int(m.size()) > liveSize) {
+        auto it = m.lower_bound(int(rng() % (4 * liveSize)));
+        m.erase(it == m.end() ? m.begin() : it);
+    }
+}
+
+template<typename Set>
+void churnSet(Set& s, std::mt19937& rng, int liveSize) {
+    s.insert(int(rng() % (4 * liveSize)));
+    if(int(s.size()) > liveSize) {
+        auto it = s.lower_bound(int(rng() % (4 * liveSize)));
+        s.erase(it == s.end() ? s.begin() : it);
+    }
+}
+
+// every thread churns its own containers - there is no sharing of data, so any slowdown with more threads comes from the allocator
+template<template<typename> class Alloc>
+double operationsPerSecond(int numThreads, long opsPerThread) {
+    constexpr int liveSize = 1000;
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for(int t=0; t<numThreads; t++) {
+        threads.emplace_back([opsPerThread, t] {
+            std::mt19937 rng(t + 1);
+            typename containers<Alloc>::list l;
+            typename containers<Alloc>::forwardList fl;
+            typename containers<Alloc>::map m;
+            typename containers<Alloc>::set s;
+            int flSize = 0;
+            for(long i=0; i<opsPerThread; i+=4) {
+                churnList(l, rng, liveSize);
+                churnForwardList(fl, rng, liveSize, flSize);
+                churnMap(m, rng, liveSize);
+                churnSet(s, rng, liveSize);
+            }
+        });
+    }
+    for(auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return numThreads * opsPerThread / elapsed.count();
+}
+
+// a container with static storage duration - constructed before the depot and the main thread's cache, so destroyed after both.
+// its nodes are freed at exit, which needs the depot (and its slabs) to still be there
+containers<PoolAllocator>::list staticList;
+
+int main(int argc, char* argv[]) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 32;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 2000000;
+
+    // nodes which cross threads - allocated on a worker thread, freed into the cache of the main thread
+    containers<PoolAllocator>::map handedOver;
+    std::thread builder([&handedOver] { for(int i=0; i<10000; i++) handedOver.emplace(i, i); });
+    builder.join();
+    std::cout << "map built on another thread: " << handedOver.size() << " elements" << std::endl;
+    handedOver.clear();
+
+    // nodes freed at thread exit after the thread's cache is gone - the set is constructed before the cache, so it is destroyed
+    // after it, and its nodes go straight back to the depot
+    std::thread exiting([] {
+        thread_local containers<PoolAllocator>::set outlivesCache;
+        for(int i=0; i<1000; i++) outlivesCache.insert(i);
+    });
+    exiting.join();
+    std::cout << "set freed after the thread cache: ok" << std::endl;
+
+    for(int i=0; i<1000; i++) staticList.push_back(i);
+
+    std::cout << "threads   std::allocator ops/sec   PoolAllocator ops/sec" << std::endl;
+    for(int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        double defaultRate = operationsPerSecond<std::allocator>(numThreads, opsPerThread);
+        double poolRate = operationsPerSecond<PoolAllocator>(numThreads, opsPerThread);
+        std::cout << numThreads << "\t  " << defaultRate << "\t\t   " << poolRate << std::endl;
+    }
+
+    return 0;
+}
@@ -3,6 +3,8 @@
 #include <deque>
 #include <algorithm>
 #include <string>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -38,10 +40,10 @@ void printDeque(std::deque<int>& dq) {
     std::cout << std::endl;
 }
 
-struct A {
+struct A : instrumented<A> {
     std::string s;
-    A(std::string str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A(std::string str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 int main() {
@@ -136,23 +138,21 @@ int main() {
     // emplace functions take an array of arguments and pass it to the object's class constructor which is then invoked
     // insert function requires an already constructed object as its argument, and as a result, a copy constructor is invoked during insertion
     std::deque<A> container;
-    
-    std::cout << "construct 2 times A:\n";
     A three { "three" };
     A four { "four" };
-    
-    std::cout << "insert:\n";
     A one("one");
+
+    counterScope<A> insertScope;
     container.insert(container.begin(), one);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // at either end a deque never moves its existing elements, so none of the emplaces makes a copy
+    counterScope<A> emplaceScope;
     container.emplace(container.end(), "two");
-
-    std::cout << "emplace_front:\n";
     container.emplace_front("zero");
-
-    std::cout << "emplace_back:\n";
     container.emplace_back("five");
+    std::cout << "emplace, emplace_front, emplace_back: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
 
     return 0;
 }
\ No newline at end of file
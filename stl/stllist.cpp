@@ -2,6 +2,10 @@
 #include <iostream>
 #include <iterator>
 #include <list>
+#include <cassert>
+// counts every allocation of the program through the hook in instrumentation.hpp
+#define INSTRUMENTATION_HOOK_NEW
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -29,11 +33,11 @@ void printList(std::list<int> l) {
     std::cout << std::endl;
 }
 
-struct A
+struct A : instrumented<A>
 {
     std::string s;
-    A(std::string str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A(std::string str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 int main() {
@@ -197,17 +201,24 @@ int main() {
     // in both cases, the type of constructor run is different (copy and parameterised respectively)
 
     std::list<A> container;
-
-    std::cout << "construct 2 times A:\n";
     A two { "two" };
     A three { "three" };
-    
-    std::cout << "insert:\n";
     A zero("zero");
+
+    counterScope<A> insertScope;
     container.insert(container.begin(), zero);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // a list node is constructed in place and the other nodes never move, so emplace makes no copy at all
+    counterScope<A> emplaceScope;
     container.emplace(container.end(), "one"); 
+    std::cout << "emplace: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
+
+    // every element of a list lives in its own node, so every insertion is one allocation
+    allocationCounts before = allocationSnapshot();
+    for(int i=0; i<100; i++) container.emplace_back("more");
+    std::cout << "100 emplace_back: " << (allocationSnapshot() - before).allocations << " allocations" << std::endl;
     
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <set>
 #include <vector>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -20,11 +22,11 @@ void printMultiset(std::multiset<int> ms) {
     std::cout << std::endl;
 }
 
-class A {
+class A : instrumented<A> {
     public: 
     int x;
-    A(int x) { this->x = x; std::cout << " constructed\n"; }
-    A(const A& o) { x = o.x; std::cout << " copy constructed\n"; }
+    A(int x) { this->x = x; }
+    A(const A& o) : instrumented(o) { x = o.x; }
     bool operator<(const A& other) const {
         return x < other.x;
     }
@@ -165,20 +167,20 @@ int main() {
    
     // emplace and emplace_hint are applied for achieving faster performance for insertion when the container involves complex objects
     std::multiset<A> ms;
-
-    std::cout << "construct object of A twice:\n";
     A one{1};
     A two(2);
-
-    std::cout << "insert:\n";
     A three(3);
+
+    counterScope<A> insertScope;
     ms.insert(three);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // the node is constructed in place from the arguments, and tree nodes never move
+    counterScope<A> emplaceScope;
     ms.emplace(4);
-
-    std::cout << "emplace with hint:\n";
     ms.emplace_hint(ms.begin(), 0);
+    std::cout << "emplace, emplace_hint: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
     std::cout << " first element: " << ms.begin()->x << std::endl;
 
     return 0;
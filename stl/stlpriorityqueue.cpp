@@ -3,6 +3,7 @@
 #include <queue>
 #include <vector>
 #include <deque>
+#include "../advconcepts/instrumentation.hpp"
 
 // priority_queue is a container adaptor that provides constant lookup time for the largest (by default) element, and logarithmic insertion and extraction
 // we can provide a custom comparator function which would change the ordering (std::greater<int> would make smallest element to appear at the top)
@@ -16,10 +17,10 @@
 // algorithms like Dijkstra's use this to find the shortest path from source to destnation in a graph, and a task scheduler where tasks
 // with higher priority need to be executed first
 
-struct A {
+struct A : instrumented<A> {
     std::string s;
-    A(const std::string& str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A(const std::string& str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 struct comp {
@@ -67,17 +68,20 @@ int main() {
     // insert function requires an already constructed object as its argument, and as a result, a copy constructor is invoked during insertion
     // demonstrating emplace in std::queue
     std::priority_queue<A, std::vector<A>, comp> pq;
-
-    std::cout << "construct objects of A 2 times:\n";
     A one("one");
     A two{"two"};
-
-    std::cout << "insert:\n";
     A zero("zero");
+
+    counterScope<A> insertScope;
     pq.push(zero);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // the new element itself is constructed in place, but it still shows copies: the vector grows, and push_heap sifts the new element
+    // into position by moving elements around - A has no move constructor, so each of those moves is a copy. how many there are depends
+    // on the growth and the shape of the heap, not on push against emplace
+    counterScope<A> emplaceScope;
     pq.emplace("four");
+    std::cout << "emplace: " << emplaceScope.delta() << std::endl;
     
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <list>
 #include <vector>
 #include <string>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -19,11 +21,11 @@
 
 // use cases for queues are wherever we need to process elements in the order in which they arrived, such as BFS algorithms or event processing systems
 
-struct A {
+struct A : instrumented<A> {
     std::string s;
-    A() : s("null") { std::cout << " default constructed\n"; }
-    A(std::string str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A() : s("null") {}
+    A(std::string str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 void printDeqQueue(std::queue<int> q) {
@@ -98,18 +100,19 @@ int main() {
     // insert function requires an already constructed object as its argument, and as a result, a copy constructor is invoked during insertion
     // demonstrating emplace in std::queue
     std::queue<A> q;
-
-    std::cout << "construct objects of A 3 times:\n";
     A one("one");
     A two{"two"};
     A three;
-
-    std::cout << "insert:\n";
     A zero("zero");
+
+    counterScope<A> insertScope;
     q.push(zero);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    counterScope<A> emplaceScope;
     q.emplace("four");
+    std::cout << "emplace: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
 
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 // set STL in CPP
 #include <iostream>
 #include <set>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -26,11 +28,11 @@ void printSet(std::set<T> s) {
     std::cout << std::endl;
 }
 
-class A {
+class A : instrumented<A> {
     public: 
     int x;
-    A(int x) { this->x = x; std::cout << " constructed\n"; }
-    A(const A& o) { x = o.x; std::cout << " copy constructed\n"; }
+    A(int x) { this->x = x; }
+    A(const A& o) : instrumented(o) { x = o.x; }
     bool operator<(const A& other) const {
         return x < other.x;
     }
@@ -158,26 +160,23 @@ int main() {
     std::cout << "After merging:\n";
     std::cout << "S1: "; printSet(s1);
     std::cout << "S2: "; printSet(s2);
-
+    */
 
     // emplace and emplace_hint are applied for achieving faster performance for insertion when the container involves complex objects
-    std::set<A> s;
-
-    std::cout << "construct object of A twice:\n";
-    A one{1};
-    A two(2);
-
-    std::cout << "insert:\n";
+    std::set<A> objects;
     A three(3);
-    s.insert(three);
 
-    std::cout << "emplace:\n";
-    s.emplace(4);
+    counterScope<A> insertScope;
+    objects.insert(three);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
+
+    // the node is built from the arguments, so neither emplace copies an A
+    counterScope<A> emplaceScope;
+    objects.emplace(4);
+    objects.emplace_hint(objects.begin(), 0);
+    std::cout << "emplace, emplace_hint: " << emplaceScope.delta() << ", first element: " << objects.begin()->x << std::endl;
+    assert(emplaceScope.delta().copies == 0);
 
-    std::cout << "emplace with hint:\n";
-    s.emplace_hint(s.begin(), 0);
-    std::cout << " first element: " << s.begin()->x << std::endl;
-    */
     // code to demonstrate how a custom Compare function can be written for a set
     // a set with the default std::less comparator
     std::set<std::string> s1;
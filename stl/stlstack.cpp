@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS: 
@@ -23,10 +25,10 @@
 
 // use case for stack comes in when we need to have the most recent result ready to be fetched, like a cache, undo functions, backtracking algorithms, etc.
 
-struct A {
+struct A : instrumented<A> {
     std::string s;
-    A(std::string str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A(std::string str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 void printDeqStack(std::stack<int> st) {
@@ -108,20 +110,18 @@ int main() {
     // emplace functions take an array of arguments and pass it to the object's class constructor which is then invoked
     // insert function requires an already constructed object as its argument, and as a result, a copy constructor is invoked during insertion
     // demonstrating emplace in std::stack
-    /*
     std::stack<A> st;
-
-    std::cout << "construct 2 times A:\n";
-    A three { "three" };
-    A four { "four" };
-    
-    std::cout << "insert:\n";
     A one("one");
+
+    counterScope<A> pushScope;
     st.push(one);
+    std::cout << "push: " << pushScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // the deque underneath never moves its elements when it grows at the back, so emplace makes no copy
+    counterScope<A> emplaceScope;
     st.emplace("two");
-    */
+    std::cout << "emplace: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
 
     return 0;
 }
\ No newline at end of file
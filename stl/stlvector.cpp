@@ -2,6 +2,8 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cassert>
+#include "../advconcepts/instrumentation.hpp"
 
 /*
     IMPORTANT LINKS:
@@ -34,10 +36,10 @@ void printVector(std::vector<int>& arr) {
     std::cout << std::endl;
 }
 
-struct A {
+struct A : instrumented<A> {
     std::string s;
-    A(std::string str) : s(std::move(str)) { std::cout << " constructed\n"; }
-    A(const A& o) : s(o.s) { std::cout << " copy constructed\n"; }
+    A(std::string str) : s(std::move(str)) {}
+    A(const A& o) : instrumented(o), s(o.s) {}
 };
 
 int main() {
@@ -187,21 +189,21 @@ int main() {
     // for insert we need to pass an already constructed object for it to be inserted to the container
     // for emplace, we can pass the arguments for the constructor to it for it to construct an object and insert it
     // in both cases, the type of constructor run is different (copy and parameterised respectively)
-    /*
     std::vector<A> container;
     container.reserve(10);
-
-    std::cout << "construct A 3 times:\n";
-    A two { "two" };
-    A three { "three" };
     A zero("zero");
 
-    std::cout << "insert:\n";
+    counterScope<A> insertScope;
     container.insert(container.begin(), zero);
+    std::cout << "insert: " << insertScope.delta() << std::endl;
 
-    std::cout << "emplace:\n";
+    // there is room for it (reserve above) and it goes at the end, so no element is copied or moved
+    counterScope<A> emplaceScope;
     container.emplace(container.end(), "one");
+    std::cout << "emplace: " << emplaceScope.delta() << std::endl;
+    assert(emplaceScope.delta().copies == 0);
 
+    /*
     // multidimensional vectors
     std::cout << "matrix contents: " << std::endl;
     std::vector<std::vector<int>> mat{{1,2,3},{4,5,6},{7,8,9}};